@@ -0,0 +1,82 @@
+// BarnesHutCheck.cpp
+// Standalone check of the Barnes-Hut solver, built by BarnesHutCheck.vcxproj next to the game.
+// Random scenes of planets and rockets are stepped under the tree, then the RMS force error
+// of the passes that ran is compared with BARNES_HUT_ERROR_TOLERANCE. Exits with 1 if any
+// scene is over it.
+#include "GameConstants.h"
+#include "GravitySimulator.h"
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    struct Scene {
+        const char* name;
+        int planets;
+        bool clustered;     // Planets bunched around a few centers instead of spread evenly
+    };
+
+    float runScene(const Scene& scene, unsigned int seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> spread(-20000.0f, 20000.0f);
+        std::normal_distribution<float> cluster(0.0f, 1500.0f);
+        std::uniform_real_distribution<float> planetMass(10.0f, 5000.0f);
+        std::uniform_real_distribution<float> planetRadius(5.0f, 60.0f);
+
+        GravitySimulator simulator;
+        simulator.setGravitySolver(GravitySolver::BARNES_HUT);
+
+        std::vector<sf::Vector2f> centers;
+        for (int c = 0; c < 4; c++) {
+            centers.push_back(sf::Vector2f(spread(random), spread(random)));
+        }
+
+        std::vector<std::unique_ptr<Planet>> planets;
+        for (int i = 0; i < scene.planets; i++) {
+            sf::Vector2f position = scene.clustered ?
+                centers[i % centers.size()] + sf::Vector2f(cluster(random), cluster(random)) :
+                sf::Vector2f(spread(random), spread(random));
+            planets.push_back(std::make_unique<Planet>(position, planetRadius(random), planetMass(random)));
+            simulator.addPlanet(planets.back().get());
+        }
+
+        std::vector<std::unique_ptr<Rocket>> rockets;
+        for (int i = 0; i < 20; i++) {
+            rockets.push_back(std::make_unique<Rocket>(sf::Vector2f(spread(random), spread(random)), sf::Vector2f(0.0f, 0.0f)));
+            simulator.addRocket(rockets.back().get());
+        }
+
+        // A few steps, so the error is measured on a state the tree has actually produced
+        for (int step = 0; step < 10; step++) {
+            simulator.update(1.0f / 60.0f);
+        }
+        return simulator.measureBarnesHutError();
+    }
+}
+
+int main()
+{
+    const Scene scenes[] = {
+        { "2 planets", 2, false },
+        { "50 planets", 50, false },
+        { "300 planets", 300, false },
+        { "1000 planets", 1000, false },
+        { "300 clustered planets", 300, true },
+        { "1000 clustered planets", 1000, true }
+    };
+
+    bool passed = true;
+    unsigned int seed = 1;
+    for (const Scene& scene : scenes) {
+        float error = runScene(scene, seed++);
+        bool ok = error <= GameConstants::BARNES_HUT_ERROR_TOLERANCE;
+        passed = passed && ok;
+        std::cout << (ok ? "ok    " : "FAIL  ") << scene.name << ": RMS force error " << error * 100.0f << "%" << std::endl;
+    }
+
+    std::cout << (passed ? "Barnes-Hut within " : "Barnes-Hut over ") <<
+        GameConstants::BARNES_HUT_ERROR_TOLERANCE * 100.0f << "% tolerance" << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
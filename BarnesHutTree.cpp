@@ -0,0 +1,186 @@
+// BarnesHutTree.cpp
+#include "BarnesHutTree.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Bodies that still share a cell at this depth are kept together in one leaf
+    constexpr int MAX_TREE_DEPTH = 32;
+}
+
+int BarnesHutTree::createNode(Vector2d center, double halfSize)
+{
+    Node node;
+    node.center = center;
+    node.halfSize = halfSize;
+    node.centerOfMass = Vector2d(0, 0);
+    node.mass = 0.0;
+    node.firstChild = -1;
+    node.firstBody = -1;
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+void BarnesHutTree::subdivide(int nodeIndex)
+{
+    Vector2d center = nodes[nodeIndex].center;
+    double quarter = nodes[nodeIndex].halfSize * 0.5;
+
+    // Children are stored consecutively: quadrant = (x >= cx) + 2 * (y >= cy)
+    int firstChild = createNode(center + Vector2d(-quarter, -quarter), quarter);
+    createNode(center + Vector2d(quarter, -quarter), quarter);
+    createNode(center + Vector2d(-quarter, quarter), quarter);
+    createNode(center + Vector2d(quarter, quarter), quarter);
+
+    // Move the body stored in this leaf down into the matching child
+    int body = nodes[nodeIndex].firstBody;
+    if (body != -1) {
+        Vector2d pos = positions[body];
+        int quadrant = (pos.x >= center.x ? 1 : 0) + (pos.y >= center.y ? 2 : 0);
+        nodes[firstChild + quadrant].firstBody = body;
+    }
+
+    nodes[nodeIndex].firstChild = firstChild;
+    nodes[nodeIndex].firstBody = -1;
+}
+
+void BarnesHutTree::insert(int body)
+{
+    Vector2d pos = positions[body];
+    int nodeIndex = 0;
+
+    for (int depth = 0; ; depth++) {
+        if (nodes[nodeIndex].firstChild == -1) {
+            // Empty leaf - store the body here
+            if (nodes[nodeIndex].firstBody == -1) {
+                nodes[nodeIndex].firstBody = body;
+                return;
+            }
+
+            // Coincident or extremely close bodies share the deepest leaf
+            if (depth >= MAX_TREE_DEPTH) {
+                nextBody[body] = nodes[nodeIndex].firstBody;
+                nodes[nodeIndex].firstBody = body;
+                return;
+            }
+
+            subdivide(nodeIndex);
+        }
+
+        Vector2d center = nodes[nodeIndex].center;
+        int quadrant = (pos.x >= center.x ? 1 : 0) + (pos.y >= center.y ? 2 : 0);
+        nodeIndex = nodes[nodeIndex].firstChild + quadrant;
+    }
+}
+
+void BarnesHutTree::build(const double* bodyX, const double* bodyY, const double* bodyMasses, const double* bodyRadii, size_t count)
+{
+    positions.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        positions[i] = Vector2d(bodyX[i], bodyY[i]);
+    }
+    masses.assign(bodyMasses, bodyMasses + count);
+    radii.assign(bodyRadii, bodyRadii + count);
+    nextBody.assign(count, -1);
+    nodes.clear();
+
+    if (positions.empty()) {
+        return;
+    }
+
+    // Square root cell enclosing every body
+    Vector2d minPos = positions[0];
+    Vector2d maxPos = positions[0];
+    for (const auto& pos : positions) {
+        minPos.x = std::min(minPos.x, pos.x);
+        minPos.y = std::min(minPos.y, pos.y);
+        maxPos.x = std::max(maxPos.x, pos.x);
+        maxPos.y = std::max(maxPos.y, pos.y);
+    }
+    Vector2d center = (minPos + maxPos) * 0.5;
+    double halfSize = std::max(maxPos.x - minPos.x, maxPos.y - minPos.y) * 0.5 + 1.0;
+
+    nodes.reserve(positions.size() * 2);
+    createNode(center, halfSize);
+    for (size_t i = 0; i < positions.size(); i++) {
+        insert(static_cast<int>(i));
+    }
+
+    // Children always come after their parent, so a reverse sweep accumulates bottom-up
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; i--) {
+        Node& node = nodes[i];
+        double mass = 0.0;
+        Vector2d weighted(0, 0);
+
+        if (node.firstChild == -1) {
+            for (int body = node.firstBody; body != -1; body = nextBody[body]) {
+                mass += masses[body];
+                weighted += positions[body] * masses[body];
+            }
+        }
+        else {
+            for (int c = 0; c < 4; c++) {
+                const Node& child = nodes[node.firstChild + c];
+                mass += child.mass;
+                weighted += child.centerOfMass * child.mass;
+            }
+        }
+
+        node.mass = mass;
+        node.centerOfMass = (mass > 0.0) ? weighted / mass : node.center;
+    }
+}
+
+Vector2d BarnesHutTree::accelerationAt(Vector2d point, double G, int skipBody,
+    double exclusionRadius, double minDistance) const
+{
+    Vector2d acceleration(0, 0);
+    if (nodes.empty()) {
+        return acceleration;
+    }
+
+    // Each opened cell replaces one stack entry with four, so depth * 3 + 4 entries suffice
+    int stack[MAX_TREE_DEPTH * 3 + 8];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (node.mass <= 0.0) continue;
+
+        if (node.firstChild == -1) {
+            // Leaf - sum its bodies exactly
+            for (int body = node.firstBody; body != -1; body = nextBody[body]) {
+                if (body == skipBody) continue;
+
+                Vector2d direction = positions[body] - point;
+                double distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+                if (distance <= radii[body] + exclusionRadius) continue;
+
+                double clamped = std::max(distance, minDistance);
+                acceleration += direction / distance * (G * masses[body] / (clamped * clamped));
+            }
+            continue;
+        }
+
+        Vector2d direction = node.centerOfMass - point;
+        double distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+
+        // Cells containing the point itself are always opened so a body never attracts itself
+        bool containsPoint = std::abs(point.x - node.center.x) <= node.halfSize &&
+            std::abs(point.y - node.center.y) <= node.halfSize;
+
+        if (!containsPoint && node.halfSize * 2.0 < theta * distance) {
+            // Far enough away - treat the whole cell as one body
+            double clamped = std::max(distance, minDistance);
+            acceleration += direction / distance * (G * node.mass / (clamped * clamped));
+        }
+        else {
+            for (int c = 0; c < 4; c++) {
+                stack[stackSize++] = node.firstChild + c;
+            }
+        }
+    }
+
+    return acceleration;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+// BarnesHutTree.h
+#pragma once
+#include "VectorHelper.h"
+#include <vector>
+
+// Quadtree that approximates the gravity of distant groups of bodies by their
+// combined mass at the group's center of mass (Barnes-Hut)
+class BarnesHutTree {
+private:
+    struct Node {
+        Vector2d center;            // Center of the square cell
+        double halfSize;            // Half of the cell width
+        Vector2d centerOfMass;
+        double mass;
+        int firstChild;             // Index of the first of four children, -1 for leaves
+        int firstBody;              // First body stored in a leaf, -1 if empty
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Vector2d> positions;
+    std::vector<double> masses;
+    std::vector<double> radii;
+    std::vector<int> nextBody;      // Linked list of bodies sharing a leaf
+    double theta = 0.5;
+
+    int createNode(Vector2d center, double halfSize);
+    void insert(int body);
+    void subdivide(int nodeIndex);
+
+public:
+    // Rebuild the tree from scratch for the given bodies (structure-of-arrays input)
+    void build(const double* bodyX, const double* bodyY, const double* bodyMasses, const double* bodyRadii, size_t count);
+
+    // Opening angle: cells whose width/distance ratio is below theta are treated as a single mass
+    void setOpeningAngle(double openingAngle) { theta = openingAngle; }
+    double getOpeningAngle() const { return theta; }
+
+    // Gravitational acceleration at a point. Bodies closer than their radius plus
+    // exclusionRadius are skipped, and distances are clamped to minDistance.
+    // skipBody excludes a body of the tree (its own index) or -1 for none.
+    Vector2d accelerationAt(Vector2d point, double G, int skipBody = -1,
+        double exclusionRadius = 0.0, double minDistance = 0.0) const;
+
+    size_t getNodeCount() const { return nodes.size(); }
+};
\ No newline at end of file
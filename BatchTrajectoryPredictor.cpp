@@ -0,0 +1,496 @@
+// BatchTrajectoryPredictor.cpp
+#include "BatchTrajectoryPredictor.h"
+#include "GameConstants.h"
+#include "GameObject.h"
+#include "GravityKernel.h"
+#include "GravitySimulator.h"
+#include "Rocket.h"
+#include <algorithm>
+#include <cmath>
+
+BatchTrajectoryPredictor::BatchTrajectoryPredictor()
+{
+    worker = std::thread(&BatchTrajectoryPredictor::workerLoop, this);
+}
+
+BatchTrajectoryPredictor::~BatchTrajectoryPredictor()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    pendingReady.notify_all();
+    worker.join();
+}
+
+void BatchTrajectoryPredictor::submit(const std::vector<const Rocket*>& rockets, GravitySimulator& simulator,
+    const sf::RenderWindow& window, float timeStep, int steps)
+{
+    // The copy shares the planets' prescribed paths, which are pure functions of time
+    PlanetEphemeris& ephemeris = simulator.getEphemeris();
+    if (!sharedEphemeris || sharedEphemeris->getRevision() != ephemeris.getRevision()) {
+        sharedEphemeris = std::make_shared<const PlanetEphemeris>(ephemeris);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.rockets.resize(rockets.size());
+        for (size_t i = 0; i < rockets.size(); i++) {
+            RocketState& state = pending.rockets[i];
+            state.rocket = rockets[i];
+            state.position = rockets[i]->getWorldPosition();
+            state.velocity = rockets[i]->getWorldVelocity();
+            state.pathRevision = rockets[i]->getTrajectoryRevision();
+            state.color = rockets[i]->getColor();
+        }
+        pending.time = simulator.getSimulationTime();
+        pending.ephemeris = sharedEphemeris;
+        pending.jobs = &simulator.getJobSystem();
+        pending.renderOrigin = GameObject::getRenderOrigin();
+        pending.timeStep = timeStep;
+        pending.steps = steps;
+        pending.integrator = Integrator::getActiveType();
+        // The view may move before the paths are drawn, so take in a margin beyond it
+        pending.pixelSize = PolylineLod::getPixelSize(window);
+        pending.bounds = PolylineLod::getViewBounds(window, GameConstants::POLYLINE_LOD_MARGIN);
+        pending.generation = generation;
+        hasPending = true;
+    }
+    pendingReady.notify_one();
+}
+
+void BatchTrajectoryPredictor::workerLoop()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex);
+            pendingReady.wait(lock, [this] { return stopping || hasPending; });
+            if (stopping) return;
+            std::swap(working, pending);
+            hasPending = false;
+        }
+
+        predict();
+
+        std::lock_guard<std::mutex> lock(frontMutex);
+        if (working.generation != generation) continue;
+        std::swap(front, back);
+        frontOrigin = working.renderOrigin;
+        frontIntegratedSteps = integratedSteps;
+        completed++;
+    }
+}
+
+void BatchTrajectoryPredictor::predict()
+{
+    // A rebuilt table replaces the worker's copy; otherwise the copy carries on extending
+    // the same motion the simulation's table would
+    if (working.ephemeris != tableSource) {
+        table = *working.ephemeris;
+        tableSource = working.ephemeris;
+    }
+    table.discardBefore(working.time);
+
+    // New planets, a different scheme or a different grid leave nothing to keep, and nor does
+    // a clear - its rockets may be gone and new ones have taken their addresses
+    if (!stages || table.getRevision() != laneRevision || working.integrator != laneIntegrator ||
+        working.timeStep != laneTimeStep || working.generation != laneGeneration) {
+        lanes.clear();
+        rowCount = 0;
+        laneRevision = table.getRevision();
+        laneGeneration = working.generation;
+        laneIntegrator = working.integrator;
+        laneTimeStep = working.timeStep;
+
+        // Where in a step each kick falls: the drift coefficients that come before it
+        stages = Integrator::getStages(laneIntegrator, stageCount);
+        kickOffsets.clear();
+        double drifted = 0.0;
+        for (int s = 0; s < stageCount; s++) {
+            if (stages[s].op == IntegratorOp::KICK) {
+                kickOffsets.push_back(drifted);
+            }
+            else {
+                drifted += stages[s].coefficient;
+            }
+        }
+
+        const size_t planetCount = table.getPlanetCount();
+        sourceMass.resize(planetCount);
+        sourceRadius.resize(planetCount);
+        for (size_t j = 0; j < planetCount; j++) {
+            sourceMass[j] = table.getMass(j);
+            sourceRadius[j] = table.getRadius(j);
+        }
+    }
+
+    if (working.rockets.empty() || working.steps <= 0 || working.timeStep <= 0.0f) {
+        lanes.clear();
+        back.clear();
+        return;
+    }
+
+    matchLanes();
+
+    // Every lane runs on to the last grid time within the horizon
+    const double step = working.timeStep;
+    const long long untilStep = static_cast<long long>(std::floor(working.time / step)) + working.steps;
+    readRows(untilStep);
+    extendLanes(untilStep);
+    buildVertices();
+}
+
+void BatchTrajectoryPredictor::matchLanes()
+{
+    // Lanes follow the rockets by identity, whatever order the players come in this frame
+    std::swap(previousLanes, lanes);
+    lanes.clear();
+    lanes.resize(working.rockets.size());
+
+    const double now = working.time;
+    std::vector<size_t> restarted;
+    for (size_t i = 0; i < working.rockets.size(); i++) {
+        const RocketState& state = working.rockets[i];
+        Lane& lane = lanes[i];
+        for (Lane& previous : previousLanes) {
+            if (previous.rocket == state.rocket) {
+                lane = std::move(previous);
+                break;
+            }
+        }
+        lane.color = state.color;
+
+        // Consume the samples the simulation has passed, keeping one at or before now
+        while (lane.samples.size() >= 2 && lane.samples[1].time <= now) {
+            lane.samples.pop_front();
+        }
+
+        // Anything that moved the rocket without a new path revision - a network correction,
+        // a teleport, or just integration error building up - shows as a gap
+        bool valid = lane.rocket == state.rocket && lane.pathRevision == state.pathRevision &&
+            lane.samples.size() >= 2 && lane.samples.front().time <= now;
+        if (valid) {
+            Vector2d gap = interpolate(lane, now) - state.position;
+            valid = std::sqrt(gap.x * gap.x + gap.y * gap.y) <= GameConstants::TRAJECTORY_CACHE_TOLERANCE;
+        }
+        if (!valid) {
+            lane.rocket = state.rocket;
+            lane.pathRevision = state.pathRevision;
+            restarted.push_back(i);
+        }
+    }
+    previousLanes.clear();
+
+    startLanes(restarted);
+}
+
+void BatchTrajectoryPredictor::readRows(long long untilStep)
+{
+    const size_t planetCount = table.getPlanetCount();
+    const size_t rowSize = kickOffsets.size() * planetCount;
+    const double step = working.timeStep;
+
+    // Let go of the rows the simulation has passed, a chunk at a time
+    const long long current = static_cast<long long>(std::floor(working.time / step));
+    if (rowCount == 0 || current >= firstRow + rowCount) {
+        firstRow = current;
+        rowCount = 0;
+        sourceX.clear();
+        sourceY.clear();
+    }
+    else if (current - firstRow >= GameConstants::BATCH_TRAJECTORY_BLOCK_STEPS) {
+        const size_t values = static_cast<size_t>(current - firstRow) * rowSize;
+        sourceX.erase(sourceX.begin(), sourceX.begin() + values);
+        sourceY.erase(sourceY.begin(), sourceY.begin() + values);
+        rowCount -= current - firstRow;
+        firstRow = current;
+    }
+
+    // The table extends itself as it is read, so it is only read here, before the lanes split
+    // up, and only for grid steps no earlier frame has read
+    sourceX.resize(static_cast<size_t>(std::max(0LL, untilStep - firstRow)) * rowSize);
+    sourceY.resize(sourceX.size());
+    for (long long k = firstRow + rowCount; k < untilStep; k++) {
+        size_t row = static_cast<size_t>(k - firstRow) * rowSize;
+        for (double offset : kickOffsets) {
+            double stageTime = (static_cast<double>(k) + offset) * step;
+            for (size_t j = 0; j < planetCount; j++, row++) {
+                Vector2d position = table.positionAt(j, stageTime);
+                sourceX[row] = position.x;
+                sourceY[row] = position.y;
+            }
+        }
+    }
+    rowCount = std::max(rowCount, untilStep - firstRow);
+}
+
+void BatchTrajectoryPredictor::startLanes(const std::vector<size_t>& restarted)
+{
+    if (restarted.empty()) return;
+
+    // One short step from now to the next grid time, shared by every lane that starts over
+    const double now = working.time;
+    const double step = working.timeStep;
+    const long long firstStep = static_cast<long long>(std::floor(now / step)) + 1;
+    const double firstTime = static_cast<double>(firstStep) * step;
+    const double shortStep = firstTime - now;
+
+    const size_t count = restarted.size();
+    for (std::vector<double>* column : { &x, &y, &vx, &vy, &accelX, &accelY }) {
+        column->resize(count);
+    }
+    hit.assign(count, 0);
+    for (size_t i = 0; i < count; i++) {
+        const RocketState& state = working.rockets[restarted[i]];
+        x[i] = state.position.x;
+        y[i] = state.position.y;
+        vx[i] = state.velocity.x;
+        vy[i] = state.velocity.y;
+    }
+
+    const size_t planetCount = table.getPlanetCount();
+    std::vector<double> startX(planetCount);
+    std::vector<double> startY(planetCount);
+    size_t kick = 0;
+    for (int s = 0; s < stageCount; s++) {
+        const double dt = static_cast<double>(stages[s].coefficient) * shortStep;
+        if (stages[s].op == IntegratorOp::KICK) {
+            double stageTime = now + kickOffsets[kick++] * shortStep;
+            for (size_t j = 0; j < planetCount; j++) {
+                Vector2d position = table.positionAt(j, stageTime);
+                startX[j] = position.x;
+                startY[j] = position.y;
+            }
+            GravitySources sources = { startX.data(), startY.data(), sourceMass.data(), sourceRadius.data(),
+                planetCount };
+            std::fill(accelX.begin(), accelX.end(), 0.0);
+            std::fill(accelY.begin(), accelY.end(), 0.0);
+            GravityKernel::accumulateOnPoints(sources, x.data(), y.data(), count, GameConstants::G,
+                GameConstants::TRAJECTORY_COLLISION_RADIUS, accelX.data(), accelY.data(), hit.data());
+            for (size_t i = 0; i < count; i++) {
+                vx[i] += accelX[i] * dt;
+                vy[i] += accelY[i] * dt;
+            }
+        }
+        else {
+            for (size_t i = 0; i < count; i++) {
+                x[i] += vx[i] * dt;
+                y[i] += vy[i] * dt;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const RocketState& state = working.rockets[restarted[i]];
+        Lane& lane = lanes[restarted[i]];
+        lane.samples.clear();
+        lane.samples.push_back({ now, state.position, state.velocity });
+        lane.nextStep = firstStep;
+        lane.ended = hit[i] != 0;
+        if (!lane.ended) {
+            lane.samples.push_back({ firstTime, Vector2d(x[i], y[i]), Vector2d(vx[i], vy[i]) });
+        }
+    }
+    integratedSteps += count;
+}
+
+void BatchTrajectoryPredictor::extendLanes(long long untilStep)
+{
+    // Lanes join the lockstep at the grid step they have reached: coasting ones where the
+    // last frame left them, restarted ones just after now
+    std::vector<size_t> waiting;
+    for (size_t i = 0; i < lanes.size(); i++) {
+        if (!lanes[i].ended && lanes[i].nextStep < untilStep) {
+            waiting.push_back(i);
+        }
+    }
+    if (waiting.empty()) return;
+    std::sort(waiting.begin(), waiting.end(), [this](size_t a, size_t b) {
+        return lanes[a].nextStep < lanes[b].nextStep;
+    });
+
+    const size_t planetCount = table.getPlanetCount();
+    const size_t kicksPerStep = kickOffsets.size();
+    const double step = working.timeStep;
+    const double G = GameConstants::G;
+    JobSystem& jobs = *working.jobs;
+
+    active.clear();
+    size_t next = 0;
+    long long k = lanes[waiting.front()].nextStep;
+    while (k < untilStep) {
+        while (next < waiting.size() && lanes[waiting[next]].nextStep == k) {
+            active.push_back(waiting[next++]);
+        }
+        if (active.empty()) {
+            if (next == waiting.size()) break;
+            k = lanes[waiting[next]].nextStep;
+            continue;
+        }
+
+        // Short blocks, so a chunk stolen by a thread waiting on its own loop is over quickly
+        long long blockEnd = std::min<long long>(untilStep, k + GameConstants::BATCH_TRAJECTORY_BLOCK_STEPS);
+        if (next < waiting.size()) {
+            blockEnd = std::min(blockEnd, lanes[waiting[next]].nextStep);
+        }
+
+        const size_t count = active.size();
+        for (std::vector<double>* column : { &x, &y, &vx, &vy, &accelX, &accelY }) {
+            column->resize(count);
+        }
+        hit.assign(count, 0);
+        ended.assign(count, 0);
+        for (size_t i = 0; i < count; i++) {
+            const LaneSample& last = lanes[active[i]].samples.back();
+            x[i] = last.position.x;
+            y[i] = last.position.y;
+            vx[i] = last.velocity.x;
+            vy[i] = last.velocity.y;
+        }
+
+        const long long blockStart = k;
+        jobs.parallelFor(count, GameConstants::BATCH_TRAJECTORY_JOB_GRAIN, [&](size_t begin, size_t end) {
+            const size_t chunk = end - begin;
+            for (long long gridStep = blockStart; gridStep < blockEnd; gridStep++) {
+                size_t kick = 0;
+                for (int s = 0; s < stageCount; s++) {
+                    const double dt = static_cast<double>(stages[s].coefficient) * step;
+                    if (stages[s].op == IntegratorOp::KICK) {
+                        const size_t first = (static_cast<size_t>(gridStep - firstRow) * kicksPerStep + kick++) *
+                            planetCount;
+                        GravitySources sources = { sourceX.data() + first, sourceY.data() + first,
+                            sourceMass.data(), sourceRadius.data(), planetCount };
+                        std::fill(accelX.begin() + begin, accelX.begin() + end, 0.0);
+                        std::fill(accelY.begin() + begin, accelY.begin() + end, 0.0);
+                        GravityKernel::accumulateOnPoints(sources, x.data() + begin, y.data() + begin, chunk, G,
+                            GameConstants::TRAJECTORY_COLLISION_RADIUS, accelX.data() + begin,
+                            accelY.data() + begin, hit.data() + begin);
+                        for (size_t i = begin; i < end; i++) {
+                            vx[i] += accelX[i] * dt;
+                            vy[i] += accelY[i] * dt;
+                        }
+                    }
+                    else {
+                        for (size_t i = begin; i < end; i++) {
+                            x[i] += vx[i] * dt;
+                            y[i] += vy[i] * dt;
+                        }
+                    }
+                }
+
+                // A lane that reached a planet ends at its last sample. It stays in the lockstep
+                // to the end of the block, but nothing more is recorded for it.
+                const double time = static_cast<double>(gridStep + 1) * step;
+                for (size_t i = begin; i < end; i++) {
+                    if (ended[i]) continue;
+                    if (hit[i]) {
+                        ended[i] = 1;
+                        continue;
+                    }
+                    lanes[active[i]].samples.push_back({ time, Vector2d(x[i], y[i]), Vector2d(vx[i], vy[i]) });
+                }
+            }
+        });
+
+        // Ended lanes leave the lockstep
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            Lane& lane = lanes[active[i]];
+            lane.nextStep = blockEnd;
+            lane.ended = ended[i] != 0;
+            if (!lane.ended) {
+                active[kept++] = active[i];
+            }
+        }
+        active.resize(kept);
+        integratedSteps += count * static_cast<size_t>(blockEnd - blockStart);
+        k = blockEnd;
+    }
+}
+
+void BatchTrajectoryPredictor::buildVertices()
+{
+    const double now = working.time;
+    const double span = static_cast<double>(working.timeStep) * working.steps;
+    const double horizon = now + span;
+    const double tolerance = GameConstants::POLYLINE_LOD_TOLERANCE * working.pixelSize;
+    const double fade = 255.0 / span;
+
+    paths.resize(lanes.size());
+    back.resize(lanes.size(), sf::VertexArray(sf::PrimitiveType::LineStrip));
+    working.jobs->parallelFor(lanes.size(), GameConstants::BATCH_TRAJECTORY_JOB_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Lane& lane = lanes[i];
+            std::vector<PolylinePoint>& path = paths[i];
+            path.clear();
+
+            // The first sample is at or behind the current time and is replaced by the rocket itself
+            path.push_back({ working.rockets[i].position, lane.color });
+            sf::Color color = lane.color;
+            for (auto sample = lane.samples.begin() + 1; sample != lane.samples.end() && sample->time <= horizon; ++sample) {
+                color.a = static_cast<uint8_t>(255.0 - (sample->time - now) * fade);
+                path.push_back({ sample->position, color });
+            }
+
+            back[i].clear();
+            PolylineLod::appendLineStrip(path, working.bounds, tolerance, working.renderOrigin, back[i]);
+        }
+    });
+}
+
+Vector2d BatchTrajectoryPredictor::interpolate(const Lane& lane, double time)
+{
+    // Cubic Hermite from the positions and velocities at both ends
+    const LaneSample& a = lane.samples[0];
+    const LaneSample& b = lane.samples[1];
+    const double h = b.time - a.time;
+    const double u = (time - a.time) / h;
+    double u2 = u * u;
+    double u3 = u2 * u;
+    double h00 = 2.0 * u3 - 3.0 * u2 + 1.0;
+    double h10 = (u3 - 2.0 * u2 + u) * h;
+    double h01 = -2.0 * u3 + 3.0 * u2;
+    double h11 = (u3 - u2) * h;
+    return a.position * h00 + a.velocity * h10 + b.position * h01 + b.velocity * h11;
+}
+
+void BatchTrajectoryPredictor::draw(sf::RenderWindow& window)
+{
+    std::lock_guard<std::mutex> lock(frontMutex);
+
+    // The paths were built around an older render origin; shift them to the current one
+    sf::RenderStates states;
+    states.transform.translate(sf::Vector2f(frontOrigin - GameObject::getRenderOrigin()));
+    for (const sf::VertexArray& path : front) {
+        window.draw(path, states);
+    }
+}
+
+void BatchTrajectoryPredictor::clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        hasPending = false;
+    }
+    std::lock_guard<std::mutex> lock(frontMutex);
+    generation++;
+    front.clear();
+}
+
+size_t BatchTrajectoryPredictor::getPathCount()
+{
+    std::lock_guard<std::mutex> lock(frontMutex);
+    return front.size();
+}
+
+size_t BatchTrajectoryPredictor::getCompletedCount()
+{
+    std::lock_guard<std::mutex> lock(frontMutex);
+    return completed;
+}
+
+size_t BatchTrajectoryPredictor::getIntegratedStepCount()
+{
+    std::lock_guard<std::mutex> lock(frontMutex);
+    return frontIntegratedSteps;
+}
\ No newline at end of file
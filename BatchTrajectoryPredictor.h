@@ -0,0 +1,160 @@
+// BatchTrajectoryPredictor.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Integrator.h"
+#include "JobSystem.h"
+#include "PlanetEphemeris.h"
+#include "PolylineLod.h"
+#include "VectorHelper.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GravitySimulator;
+class Rocket;
+
+// Predicted paths for many rockets at once - every other player in a hosted or spectated game.
+// Like TrajectoryPredictor, it runs on its own thread: each frame submits a snapshot of the
+// rockets and the planet table, and draws whichever set of paths was finished last.
+//
+// The rockets are packed as structure-of-arrays lanes and stepped in lockstep with fixed steps
+// of the active integrator on an absolute time grid, every lane landing on multiples of the
+// step. Every lane then needs the planets at the same stage times: those are read from the
+// ephemeris once per grid step and kept, and the gravity kernel runs across the rockets the
+// way it runs across particles. Chunks of lanes are independent and are spread over the job
+// system.
+//
+// As with TrajectoryCache, a lane is kept between frames and only extended to the new horizon
+// while its rocket coasts. It is started over when the rocket's path revision changes, when
+// the rocket strays from it, or when the planets, integrator or step change. A restarted lane
+// takes one short step from the rocket's state to the next grid time, then joins the others.
+class BatchTrajectoryPredictor {
+private:
+    struct RocketState {
+        const Rocket* rocket = nullptr;         // Identity only; never dereferenced by the worker
+        Vector2d position;
+        Vector2d velocity;
+        unsigned long long pathRevision = 0;
+        sf::Color color;
+    };
+
+    struct Snapshot {
+        std::vector<RocketState> rockets;
+        double time = 0.0;
+        std::shared_ptr<const PlanetEphemeris> ephemeris;   // Never changed once shared
+        JobSystem* jobs = nullptr;
+        Vector2d renderOrigin;
+        float timeStep = 0.0f;
+        int steps = 0;
+        IntegratorType integrator = IntegratorType::LEAPFROG;
+        double pixelSize = 1.0;                 // World units per pixel of the view the paths are for
+        ViewBounds bounds;                      // World rectangle of that view
+        unsigned long long generation = 0;      // Of the predictor when this was submitted
+    };
+
+    struct LaneSample {
+        double time;
+        Vector2d position;
+        Vector2d velocity;
+    };
+
+    // A rocket's path, kept between frames; its state is that of the last sample
+    struct Lane {
+        const Rocket* rocket = nullptr;
+        unsigned long long pathRevision = 0;
+        sf::Color color;
+        std::deque<LaneSample> samples;         // Front is at or just before the current time
+        long long nextStep = 0;                 // Grid step the lane takes next
+        bool ended = false;                     // Reached a planet; not extended any further
+    };
+
+    // Handed from the render thread to the worker; only the latest one is kept
+    std::mutex pendingMutex;
+    std::condition_variable pendingReady;
+    Snapshot pending;
+    bool hasPending = false;
+    bool stopping = false;
+    std::shared_ptr<const PlanetEphemeris> sharedEphemeris; // Last table handed over, render thread only
+    // Bumped by clear, so paths the worker was already building when it was called are dropped
+    // rather than published. Written by the render thread under frontMutex.
+    unsigned long long generation = 0;
+
+    // Worker-owned
+    Snapshot working;
+    std::shared_ptr<const PlanetEphemeris> tableSource;     // Where table was copied from
+    PlanetEphemeris table;
+    std::vector<Lane> lanes;                // Same order as the rockets of the last snapshot
+    std::vector<Lane> previousLanes;
+    IntegratorType laneIntegrator = IntegratorType::LEAPFROG;   // What the lanes were built with
+    float laneTimeStep = 0.0f;
+    unsigned long long laneRevision = 0;
+    unsigned long long laneGeneration = 0;
+    size_t integratedSteps = 0;
+
+    // Stages of the lanes' integrator, and where in a step each kick falls
+    const IntegratorStage* stages = nullptr;
+    int stageCount = 0;
+    std::vector<double> kickOffsets;
+
+    // Planets at every kick of grid steps firstRow on: row (step - firstRow) * kicksPerStep + kick
+    long long firstRow = 0;
+    long long rowCount = 0;
+    std::vector<double> sourceX, sourceY;
+    std::vector<double> sourceMass, sourceRadius;
+
+    // Active lanes packed for the kernel, for one block of steps
+    std::vector<size_t> active;
+    std::vector<double> x, y, vx, vy;
+    std::vector<double> accelX, accelY;
+    std::vector<unsigned char> hit;         // Set by the kernel when a lane reaches a planet
+    std::vector<unsigned char> ended;       // Lanes whose path is finished
+
+    std::vector<std::vector<PolylinePoint>> paths;
+    std::vector<sf::VertexArray> back;
+
+    // Finished paths, relative to the render origin of the snapshot they came from
+    std::mutex frontMutex;
+    std::vector<sf::VertexArray> front;
+    Vector2d frontOrigin;
+    size_t completed = 0;
+    size_t frontIntegratedSteps = 0;
+
+    std::thread worker;
+
+    void workerLoop();
+    void predict();
+    void matchLanes();
+    void readRows(long long untilStep);
+    void startLanes(const std::vector<size_t>& restarted);
+    void extendLanes(long long untilStep);
+    void buildVertices();
+
+    // Where the lane puts the rocket at a time between its first two samples
+    static Vector2d interpolate(const Lane& lane, double time);
+
+public:
+    BatchTrajectoryPredictor();
+    ~BatchTrajectoryPredictor();
+    BatchTrajectoryPredictor(const BatchTrajectoryPredictor&) = delete;
+    BatchTrajectoryPredictor& operator=(const BatchTrajectoryPredictor&) = delete;
+
+    // Ask for the paths of these rockets as they are now, over steps fixed steps, for drawing
+    // in the window's current view. Cheap apart from copying the planet table when it was
+    // rebuilt; a snapshot the worker hasn't started on yet is replaced.
+    void submit(const std::vector<const Rocket*>& rockets, GravitySimulator& simulator,
+        const sf::RenderWindow& window, float timeStep, int steps);
+
+    // Draw the last finished paths at the current render origin
+    void draw(sf::RenderWindow& window);
+
+    // Forget the current paths, e.g. when the game ends
+    void clear();
+
+    size_t getPathCount();
+    // Prediction runs finished so far, and lane steps integrated by them
+    size_t getCompletedCount();
+    size_t getIntegratedStepCount();
+};
\ No newline at end of file
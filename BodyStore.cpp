@@ -0,0 +1,36 @@
+// BodyStore.cpp
+#include "BodyStore.h"
+
+size_t BodyStore::add(double posX, double posY, double velX, double velY, double bodyMass, double bodyRadius, std::uint32_t bodyFlags)
+{
+    x.push_back(posX);
+    y.push_back(posY);
+    vx.push_back(velX);
+    vy.push_back(velY);
+    mass.push_back(bodyMass);
+    radius.push_back(bodyRadius);
+    flags.push_back(bodyFlags);
+    return x.size() - 1;
+}
+
+void BodyStore::clear()
+{
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    mass.clear();
+    radius.clear();
+    flags.clear();
+}
+
+void BodyStore::reserve(size_t count)
+{
+    x.reserve(count);
+    y.reserve(count);
+    vx.reserve(count);
+    vy.reserve(count);
+    mass.reserve(count);
+    radius.reserve(count);
+    flags.reserve(count);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// BodyStore.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bit flags describing a body in the store
+namespace BodyFlags {
+    constexpr std::uint32_t PLANET = 1u << 0;
+    constexpr std::uint32_t ROCKET = 1u << 1;
+    constexpr std::uint32_t PINNED = 1u << 2;       // Held in place
+    constexpr std::uint32_t PRESCRIBED = 1u << 3;   // Follows a path given by time
+    constexpr std::uint32_t KINEMATIC = PINNED | PRESCRIBED;    // Never moved by gravity
+}
+
+// Contiguous structure-of-arrays copy of the simulated bodies, in double precision
+// like the objects they come from. Force passes
+// stream through these packed arrays instead of chasing pointers into
+// GameObjects that also carry their render shapes.
+struct BodyStore {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> vx;
+    std::vector<double> vy;
+    std::vector<double> mass;
+    std::vector<double> radius;
+    std::vector<std::uint32_t> flags;
+
+    size_t add(double posX, double posY, double velX, double velY, double bodyMass, double bodyRadius, std::uint32_t bodyFlags);
+    void clear();
+    void reserve(size_t count);
+    size_t size() const { return x.size(); }
+};
\ No newline at end of file
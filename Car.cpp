@@ -14,7 +14,7 @@ Car::Car(sf::Vector2f pos, sf::Vector2f vel, sf::Color col)
     body.setSize({ GameConstants::CAR_BODY_WIDTH, GameConstants::CAR_BODY_HEIGHT });
     body.setFillColor(color);
     body.setOrigin({ GameConstants::CAR_BODY_WIDTH / 2, GameConstants::CAR_BODY_HEIGHT / 2 });
-    body.setPosition(position);
+    body.setPosition(getRenderPosition());
 
     // Create wheels
     for (int i = 0; i < 2; i++) {
@@ -33,6 +33,7 @@ Car::Car(sf::Vector2f pos, sf::Vector2f vel, sf::Color col)
 }
 
 void Car::accelerate(float amount) {
+    rest.wake();
     if (isGrounded) {
         speed += amount * 10.0f; // Increased for better response
         speed = std::min(speed, maxSpeed);
@@ -41,6 +42,7 @@ void Car::accelerate(float amount) {
 }
 
 void Car::rotate(float amount) {
+    rest.wake();
     if (isGrounded) {
         rotation += amount * 2.0f; // Increased for better response
     }
@@ -48,12 +50,12 @@ void Car::rotate(float amount) {
 
 void Car::checkGrounding(const std::vector<Planet*>& planets) {
     isGrounded = false;
-    float closestDistance = FLT_MAX;
+    double closestDistance = DBL_MAX;
     currentPlanet = nullptr;
 
     for (const auto& planet : planets) {
-        sf::Vector2f direction = position - planet->getPosition();
-        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        Vector2d direction = position - planet->getWorldPosition();
+        double distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
 
         // Check if we're at or very close to the surface
         if (distance <= (planet->getRadius() + GameConstants::ROCKET_SIZE) && distance < closestDistance) {
@@ -65,39 +67,54 @@ void Car::checkGrounding(const std::vector<Planet*>& planets) {
 }
 
 void Car::update(float deltaTime) {
+    previousPosition = position;
+
+    if (rest.isSleeping() && rest.carry(position, velocity, deltaTime)) {
+        return;
+    }
+
     if (isGrounded && currentPlanet) {
         // Get direction to planet center
-        sf::Vector2f toPlanet = currentPlanet->getPosition() - position;
-        float distToPlanet = std::sqrt(toPlanet.x * toPlanet.x + toPlanet.y * toPlanet.y);
-        sf::Vector2f normal = toPlanet / distToPlanet;
+        Vector2d toPlanet = currentPlanet->getWorldPosition() - position;
+        double distToPlanet = std::sqrt(toPlanet.x * toPlanet.x + toPlanet.y * toPlanet.y);
+        Vector2d normal = toPlanet / distToPlanet;
 
         // Calculate tangent direction (perpendicular to normal)
-        sf::Vector2f tangent(-normal.y, normal.x);
+        Vector2d tangent(-normal.y, normal.x);
 
         // Apply rotation
         float radians = rotation * 3.14159f / 180.0f;
-        sf::Vector2f moveDir(std::cos(radians), std::sin(radians));
+        Vector2d moveDir(std::cos(radians), std::sin(radians));
 
         // Project movement direction onto surface tangent
-        float dotProduct = moveDir.x * tangent.x + moveDir.y * tangent.y;
-        sf::Vector2f effectiveDir = tangent * dotProduct;
+        double dotProduct = moveDir.x * tangent.x + moveDir.y * tangent.y;
+        Vector2d effectiveDir = tangent * dotProduct;
 
         // Move along surface
-        position += effectiveDir * speed * deltaTime;
+        position += effectiveDir * static_cast<double>(speed * deltaTime);
 
         // Apply gravity to stick to surface
-        position = currentPlanet->getPosition() + normal * (currentPlanet->getRadius() + GameConstants::TRAJECTORY_COLLISION_RADIUS);
+        position = currentPlanet->getWorldPosition() + normal * static_cast<double>(currentPlanet->getRadius() + GameConstants::TRAJECTORY_COLLISION_RADIUS);
 
         // Apply friction
         speed *= 0.98f;
+
+        // Parked once it has all but stopped
+        if (rest.settle(std::abs(speed) < GameConstants::SLEEP_SPEED, deltaTime)) {
+            speed = 0.0f;
+            velocity = currentPlanet->getWorldVelocity();
+            rest.sleep(currentPlanet, position);
+        }
     }
     else {
         // If in air, apply simple physics (fall with gravity)
-        position += velocity * deltaTime;
+        position += velocity * static_cast<double>(deltaTime);
+        rest.settle(false, deltaTime);
     }
+}
 
-    // Update visual components
-    body.setPosition(position);
+void Car::updateVisuals(sf::Vector2f renderPosition) {
+    body.setPosition(renderPosition);
     body.setRotation(sf::degrees(rotation));
 
     // Update wheels position
@@ -105,17 +122,20 @@ void Car::update(float deltaTime) {
     float cos_val = std::cos(radians);
     float sin_val = std::sin(radians);
 
-    wheels[0].setPosition(position + sf::Vector2f(-10.0f * cos_val + 7.5f * sin_val,
+    wheels[0].setPosition(renderPosition + sf::Vector2f(-10.0f * cos_val + 7.5f * sin_val,
         -10.0f * sin_val - 7.5f * cos_val));
-    wheels[1].setPosition(position + sf::Vector2f(10.0f * cos_val + 7.5f * sin_val,
+    wheels[1].setPosition(renderPosition + sf::Vector2f(10.0f * cos_val + 7.5f * sin_val,
         10.0f * sin_val - 7.5f * cos_val));
 
     // Update arrow position
-    directionArrow.setPosition(position + sf::Vector2f(15.0f * cos_val, 15.0f * sin_val));
+    directionArrow.setPosition(renderPosition + sf::Vector2f(15.0f * cos_val, 15.0f * sin_val));
     directionArrow.setRotation(sf::degrees(rotation));
 }
 
 void Car::draw(sf::RenderWindow& window) {
+    // Visuals follow the interpolated position, not the last simulation step
+    updateVisuals(getRenderPosition());
+
     window.draw(body);
     window.draw(wheels[0]);
     window.draw(wheels[1]);
@@ -128,15 +148,17 @@ void Car::drawWithConstantSize(sf::RenderWindow& window, float zoomLevel) {
 }
 
 void Car::initializeFromRocket(const Rocket* rocket) {
-    position = rocket->getPosition();
-    velocity = rocket->getVelocity() * GameConstants::TRANSFORM_VELOCITY_FACTOR;
+    rest.wake();
+    position = rocket->getWorldPosition();
+    previousPosition = position;
+    velocity = rocket->getWorldVelocity() * static_cast<double>(GameConstants::TRANSFORM_VELOCITY_FACTOR);
     // You'll need to add this constant // Reduce velocity when transforming
 
     // Set car tangent to planet surface if near a planet
     if (currentPlanet) {
-        sf::Vector2f toPlanet = currentPlanet->getPosition() - position;
-        float distToPlanet = std::sqrt(toPlanet.x * toPlanet.x + toPlanet.y * toPlanet.y);
-        sf::Vector2f normal = toPlanet / distToPlanet;
+        Vector2d toPlanet = currentPlanet->getWorldPosition() - position;
+        double distToPlanet = std::sqrt(toPlanet.x * toPlanet.x + toPlanet.y * toPlanet.y);
+        Vector2d normal = toPlanet / distToPlanet;
 
         // Calculate angle for proper orientation on the surface
         rotation = std::atan2(-normal.x, normal.y) * 180.0f / 3.14159f;
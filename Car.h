@@ -2,6 +2,7 @@
 #pragma once
 #include "GameObject.h"
 #include "Planet.h"
+#include "SurfaceRest.h"
 #include <vector>
 
 class Rocket; // Forward declaration
@@ -16,6 +17,10 @@ private:
     float maxSpeed;
     Planet* currentPlanet;
     bool isGrounded;
+    SurfaceRest rest;
+
+    // Place body, wheels and arrow around the given position
+    void updateVisuals(sf::Vector2f renderPosition);
 
 public:
     Car(sf::Vector2f pos, sf::Vector2f vel, sf::Color col = sf::Color::Green);
@@ -23,6 +28,8 @@ public:
     void accelerate(float amount);
     void rotate(float amount);
     bool isOnGround() const { return isGrounded; }
+    // Parked: carried with its planet without re-checking the ground until driven again
+    bool isSleeping() const { return rest.isSleeping(); }
     void checkGrounding(const std::vector<Planet*>& planets);
 
     void update(float deltaTime) override;
@@ -0,0 +1,190 @@
+// ConicTrajectory.cpp
+#include "ConicTrajectory.h"
+#include "GameConstants.h"
+#include "PlanetEphemeris.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr int BISECTION_STEPS = 40;
+    constexpr double MAX_CHECK_ANGLE = 0.5;  // Keeps the arc length estimate of a check stride honest
+}
+
+int ConicTrajectory::findDominantPlanet(PlanetEphemeris& table, double time, const Vector2d& point) const
+{
+    // Spheres from the planets where the table puts them at the requested time
+    const Vector2d rootPosition = table.positionAt(rootPlanet, time);
+    int dominant = rootPlanet;
+    double smallest = 0.0;
+    for (size_t j = 0; j < table.getPlanetCount(); j++) {
+        if (static_cast<int>(j) == rootPlanet) continue;
+        Vector2d planet = table.positionAt(j, time);
+        double soi = distance(planet, rootPosition) * influenceScale[j];
+        if (distance(point, planet) < soi && (dominant == rootPlanet || soi < smallest)) {
+            dominant = static_cast<int>(j);
+            smallest = soi;
+        }
+    }
+    return dominant;
+}
+
+Vector2d ConicTrajectory::worldPositionAt(PlanetEphemeris& table, double anomaly, double& time) const
+{
+    time = orbit.timeAt(anomaly);
+    return table.positionAt(centralPlanet, time) + orbit.positionAtTrueAnomaly(anomaly);
+}
+
+double ConicTrajectory::influenceMargin(PlanetEphemeris& table, double anomaly) const
+{
+    double time = 0.0;
+    Vector2d position = worldPositionAt(table, anomaly, time);
+    const Vector2d rootPosition = table.positionAt(rootPlanet, time);
+
+    // Leaving the central planet's sphere, or entering any smaller one, hands the rocket over
+    double margin = std::numeric_limits<double>::infinity();
+    double centralSphere = std::numeric_limits<double>::infinity();
+    if (centralPlanet != rootPlanet) {
+        Vector2d planet = table.positionAt(centralPlanet, time);
+        centralSphere = distance(planet, rootPosition) * influenceScale[centralPlanet];
+        margin = centralSphere - distance(position, planet);
+    }
+    for (size_t j = 0; j < table.getPlanetCount(); j++) {
+        if (static_cast<int>(j) == rootPlanet || static_cast<int>(j) == centralPlanet) continue;
+        Vector2d planet = table.positionAt(j, time);
+        double sphere = distance(planet, rootPosition) * influenceScale[j];
+        if (sphere < centralSphere) {
+            margin = std::min(margin, distance(position, planet) - sphere);
+        }
+    }
+    return margin;
+}
+
+bool ConicTrajectory::fit(PlanetEphemeris& table, double time, const Vector2d& position, const Vector2d& velocity, double horizon)
+{
+    rootPlanet = -1;
+    for (size_t j = 0; j < table.getPlanetCount(); j++) {
+        if (rootPlanet < 0 || table.getMass(j) > table.getMass(rootPlanet)) {
+            rootPlanet = static_cast<int>(j);
+        }
+    }
+    if (rootPlanet < 0) return false;
+    influenceScale.resize(table.getPlanetCount());
+    for (size_t j = 0; j < table.getPlanetCount(); j++) {
+        influenceScale[j] = std::pow(table.getMass(j) / table.getMass(rootPlanet), 0.4);
+    }
+
+    centralPlanet = findDominantPlanet(table, time, position);
+
+    Vector2d planetPosition;
+    Vector2d planetVelocity;
+    table.stateAt(centralPlanet, time, planetPosition, planetVelocity);
+    Vector2d relative = position - planetPosition;
+    double r = std::sqrt(relative.x * relative.x + relative.y * relative.y);
+    double surface = table.getRadius(centralPlanet) + GameConstants::TRAJECTORY_COLLISION_RADIUS;
+    if (r <= surface) return false;
+
+    orbit = KeplerOrbit(relative, velocity - planetVelocity, GameConstants::G * table.getMass(centralPlanet), time);
+    if (orbit.getSemiLatusRectum() < 1e-6 * r) return false;
+
+    // Furthest the conic can go: once round, or just short of a hyperbola's asymptote
+    startAnomaly = orbit.getTrueAnomalyAtEpoch();
+    endAnomaly = orbit.isBound() ? startAnomaly + 2.0 * PI : 0.999999 * orbit.getAsymptoteAnomaly();
+    leavesInfluence = false;
+    reachesSurface = false;
+
+    // First time after now that the radius comes down to the surface: r = p / (1 + e cos v)
+    const double e = orbit.getEccentricity();
+    const double p = orbit.getSemiLatusRectum();
+    if (e > 0.0 && orbit.getPeriapsis() < surface) {
+        double c = std::min(1.0, (p / surface - 1.0) / e);
+        double touch = -std::acos(c);                   // Inbound crossing, in (-pi, 0]
+        while (touch < startAnomaly) touch += 2.0 * PI;
+        if (touch < endAnomaly) {
+            endAnomaly = touch;
+            reachesSurface = true;
+        }
+    }
+
+    // Cut at the horizon; time only increases with the anomaly
+    if (orbit.timeAt(endAnomaly) > horizon) {
+        double low = startAnomaly;
+        double high = endAnomaly;
+        for (int i = 0; i < BISECTION_STEPS; i++) {
+            double middle = 0.5 * (low + high);
+            (orbit.timeAt(middle) > horizon ? high : low) = middle;
+        }
+        endAnomaly = low;
+        reachesSurface = false;
+    }
+
+    // Walk the conic and stop at the first point that has left the sphere of influence, then
+    // narrow down the crossing. Far from every boundary the walk takes half the margin at a
+    // time, which leaves room for the planets moving too.
+    double anomaly = startAnomaly;
+    double margin = influenceMargin(table, anomaly);
+    const double checkDistance = GameConstants::TRAJECTORY_CONIC_CHECK_DISTANCE;
+    while (anomaly < endAnomaly) {
+        double cosine = std::cos(anomaly);
+        double radius = p / (1.0 + e * cosine);
+        double q = 1.0 + e * e + 2.0 * e * cosine;
+        double arcRate = radius * radius * std::sqrt(q) / p;    // ds / dv
+        double stride = std::max(checkDistance, 0.5 * margin);
+        double next = std::min(endAnomaly, anomaly + std::min(MAX_CHECK_ANGLE, stride / arcRate));
+        margin = influenceMargin(table, next);
+        if (margin <= 0.0) {
+            double low = anomaly;
+            double high = next;
+            for (int i = 0; i < BISECTION_STEPS; i++) {
+                double middle = 0.5 * (low + high);
+                (influenceMargin(table, middle) > 0.0 ? low : high) = middle;
+            }
+            endAnomaly = low;
+            leavesInfluence = true;
+            reachesSurface = false;
+            break;
+        }
+        anomaly = next;
+    }
+
+    endTime = orbit.timeAt(endAnomaly);
+    return true;
+}
+
+void ConicTrajectory::getEndState(PlanetEphemeris& table, Vector2d& position, Vector2d& velocity) const
+{
+    Vector2d planetPosition;
+    Vector2d planetVelocity;
+    table.stateAt(centralPlanet, endTime, planetPosition, planetVelocity);
+    Vector2d relativeVelocity;
+    orbit.stateAt(endTime, position, relativeVelocity);
+    position += planetPosition;
+    velocity = relativeVelocity + planetVelocity;
+}
+
+void ConicTrajectory::tessellate(PlanetEphemeris& table, double tolerance, double startTime, double span,
+    std::vector<std::pair<Vector2d, float>>& points) const
+{
+    const double e = orbit.getEccentricity();
+    const double p = orbit.getSemiLatusRectum();
+    const double maxAngle = GameConstants::TRAJECTORY_CONIC_MAX_ANGLE;
+
+    double anomaly = startAnomaly;
+    while (anomaly < endAnomaly) {
+        // A chord of length L across a curve of radius rho sags by about L^2 / (8 rho).
+        // For a conic rho = p q^1.5 / (1 + e cos v)^3 and ds / dv = r^2 sqrt(q) / p.
+        double cosine = std::cos(anomaly);
+        double q = 1.0 + e * e + 2.0 * e * cosine;
+        double bend = 1.0 + e * cosine;
+        double curvatureRadius = p * q * std::sqrt(q) / (bend * bend * bend);
+        double radius = p / bend;
+        double arcRate = radius * radius * std::sqrt(q) / p;
+        double chord = std::sqrt(8.0 * curvatureRadius * tolerance);
+        anomaly = std::min(endAnomaly, anomaly + std::min(maxAngle, chord / arcRate));
+
+        double time = 0.0;
+        Vector2d position = worldPositionAt(table, anomaly, time);
+        points.push_back({ position, static_cast<float>((time - startTime) / span) });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+// ConicTrajectory.h
+#pragma once
+#include "KeplerOrbit.h"
+#include "VectorHelper.h"
+#include <utility>
+#include <vector>
+
+class PlanetEphemeris;
+
+// The part of a predicted path that is a plain Kepler conic: the rocket's orbit around the
+// planet whose sphere of influence it is in, followed until it leaves that sphere, reaches
+// the planet's surface, goes once round, or reaches the end of the prediction. Fitting and
+// drawing it takes microseconds where integrating the same arc takes thousands of steps.
+class ConicTrajectory {
+private:
+    KeplerOrbit orbit;          // Relative to the central planet
+    int centralPlanet = -1;
+    double startAnomaly = 0.0;
+    double endAnomaly = 0.0;
+    double endTime = 0.0;
+    bool leavesInfluence = false;
+    bool reachesSurface = false;
+
+    // Spheres of influence are (m / M)^0.4 of a planet's distance to the heaviest planet
+    int rootPlanet = -1;
+    std::vector<double> influenceScale;
+
+    // Where the conic puts the rocket in the world at a true anomaly, and when
+    Vector2d worldPositionAt(PlanetEphemeris& table, double anomaly, double& time) const;
+    // Planet whose sphere of influence holds the point at this time: the innermost one, or
+    // the heaviest planet if none does - the same rule as the simulation's patched conics
+    int findDominantPlanet(PlanetEphemeris& table, double time, const Vector2d& point) const;
+    // How far the rocket is from changing dominant planet at a true anomaly: the distance to
+    // the nearest sphere boundary that matters, negative once it has crossed one
+    double influenceMargin(PlanetEphemeris& table, double anomaly) const;
+
+public:
+
+    // Fit the conic for a rocket in this state and find where it ends, at the latest at
+    // horizon. Returns false if the rocket isn't on a usable conic: inside a planet's collision
+    // radius, or falling straight down.
+    bool fit(PlanetEphemeris& table, double time, const Vector2d& position, const Vector2d& velocity, double horizon);
+
+    // True if the path continues past the conic and has to be integrated from its end
+    bool needsContinuation() const { return leavesInfluence; }
+    bool endsAtPlanet() const { return reachesSurface; }
+    double getEndTime() const { return endTime; }
+    int getCentralPlanet() const { return centralPlanet; }
+    const KeplerOrbit& getOrbit() const { return orbit; }
+    // World state where the conic ends
+    void getEndState(PlanetEphemeris& table, Vector2d& position, Vector2d& velocity) const;
+
+    // Append points along the conic (world position, fraction of span since startTime). Steps
+    // adapt to the local curvature so no chord strays more than tolerance from the curve.
+    void tessellate(PlanetEphemeris& table, double tolerance, double startTime, double span,
+        std::vector<std::pair<Vector2d, float>>& points) const;
+};
\ No newline at end of file
@@ -0,0 +1,212 @@
+// ConservationMonitor.cpp
+#include "ConservationMonitor.h"
+#include "GameConstants.h"
+#include <algorithm>
+#include <cmath>
+
+ConservationMonitor::ConservationMonitor()
+    : interval(GameConstants::DIAGNOSTICS_INTERVAL), capacity(GameConstants::DIAGNOSTICS_HISTORY)
+{
+}
+
+double ConservationMonitor::relativeChange(double change, double scale)
+{
+    // A quantity that started at zero is measured in absolute terms
+    return std::abs(change) / (scale > 0.0 ? scale : 1.0);
+}
+
+bool ConservationMonitor::interacts(std::uint32_t a, std::uint32_t b, bool planetPairs, bool rocketPairs)
+{
+    // Rockets are always pulled by planets; the other pairings depend on the settings
+    const bool aPlanet = (a & BodyFlags::PLANET) != 0;
+    const bool bPlanet = (b & BodyFlags::PLANET) != 0;
+    return !((aPlanet && bPlanet && !planetPairs) || (!aPlanet && !bPlanet && !rocketPairs));
+}
+
+ConservationSample ConservationMonitor::measure(const BodyStore& bodies, double G, double time,
+    bool planetPairs, bool rocketPairs, const Vector2d& origin)
+{
+    ConservationSample sample;
+    sample.time = time;
+
+    const size_t count = bodies.size();
+    for (size_t i = 0; i < count; i++) {
+        if (bodies.flags[i] & BodyFlags::KINEMATIC) continue;
+        const double m = bodies.mass[i];
+        const double vx = bodies.vx[i];
+        const double vy = bodies.vy[i];
+        sample.kineticEnergy += 0.5 * m * (vx * vx + vy * vy);
+        sample.momentum += Vector2d(m * vx, m * vy);
+        sample.angularMomentum += m * ((bodies.x[i] - origin.x) * vy - (bodies.y[i] - origin.y) * vx);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            if (!interacts(bodies.flags[i], bodies.flags[j], planetPairs, rocketPairs)) continue;
+
+            double dx = bodies.x[j] - bodies.x[i];
+            double dy = bodies.y[j] - bodies.y[i];
+            double distance = std::sqrt(dx * dx + dy * dy);
+            if (distance > 0.0) {
+                sample.potentialEnergy -= G * bodies.mass[i] * bodies.mass[j] / distance;
+            }
+        }
+    }
+
+    sample.energy = sample.kineticEnergy + sample.potentialEnergy;
+    return sample;
+}
+
+ConservationMonitor::ExternalRates ConservationMonitor::measureExternal(const BodyStore& bodies, double G,
+    bool planetPairs, bool rocketPairs, const Vector2d& origin)
+{
+    ExternalRates rates;
+    const size_t count = bodies.size();
+    for (size_t k = 0; k < count; k++) {
+        if (!(bodies.flags[k] & BodyFlags::KINEMATIC)) continue;
+        for (size_t j = 0; j < count; j++) {
+            if (j == k || !interacts(bodies.flags[k], bodies.flags[j], planetPairs, rocketPairs)) continue;
+
+            double dx = bodies.x[j] - bodies.x[k];
+            double dy = bodies.y[j] - bodies.y[k];
+            double distanceSquared = dx * dx + dy * dy;
+            if (distanceSquared <= 0.0) continue;
+            double scale = -G * bodies.mass[k] * bodies.mass[j] / (distanceSquared * std::sqrt(distanceSquared));
+            Vector2d pull(scale * dx, scale * dy);
+
+            // The pull on a free body changes its momentum; the reaction on the planet is
+            // absorbed by whatever holds it, and does work only if the planet moves
+            if (!(bodies.flags[j] & BodyFlags::KINEMATIC)) {
+                rates.force += pull;
+                rates.torque += (bodies.x[j] - origin.x) * pull.y - (bodies.y[j] - origin.y) * pull.x;
+            }
+            rates.power += pull.x * bodies.vx[k] + pull.y * bodies.vy[k];
+        }
+    }
+    return rates;
+}
+
+void ConservationMonitor::accumulate(const BodyStore& bodies, double G, double dt, bool planetPairs, bool rocketPairs)
+{
+    ExternalRates rates = measureExternal(bodies, G, planetPairs, rocketPairs, origin);
+    if (hasRates) {
+        externalImpulse += (lastRates.force + rates.force) * (0.5 * dt);
+        externalAngularImpulse += 0.5 * (lastRates.torque + rates.torque) * dt;
+        externalWork += 0.5 * (lastRates.power + rates.power) * dt;
+    }
+    lastRates = rates;
+    hasRates = true;
+}
+
+bool ConservationMonitor::tick()
+{
+    if (!enabled) {
+        return false;
+    }
+    if (--ticksUntilSample > 0) {
+        return false;
+    }
+    ticksUntilSample = interval;
+    return true;
+}
+
+void ConservationMonitor::record(const BodyStore& bodies, double G, double time, bool planetPairs, bool rocketPairs,
+    bool disturbed)
+{
+    double totalMass = 0.0;
+    size_t heaviest = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        totalMass += bodies.mass[i];
+        if (bodies.mass[i] > bodies.mass[heaviest]) {
+            heaviest = i;
+        }
+    }
+
+    // Bodies joining or leaving change the totals without any integration error
+    const bool rebaseline = !hasBaseline || bodies.size() != baselineBodies || totalMass != baselineMass;
+    if (rebaseline) {
+        origin = bodies.size() > 0 ? Vector2d(bodies.x[heaviest], bodies.y[heaviest]) : Vector2d();
+    }
+    ConservationSample sample = measure(bodies, G, time, planetPairs, rocketPairs, origin);
+
+    if (rebaseline) {
+        // Start integrating the kinematic planets' share from here
+        lastRates = measureExternal(bodies, G, planetPairs, rocketPairs, origin);
+        hasRates = true;
+        externalImpulse = Vector2d();
+        externalAngularImpulse = 0.0;
+        externalWork = 0.0;
+
+        baseline = sample;
+        baselineBodies = bodies.size();
+        baselineMass = totalMass;
+        momentumScale = 0.0;
+        angularMomentumScale = 0.0;
+        for (size_t i = 0; i < bodies.size(); i++) {
+            if (bodies.flags[i] & BodyFlags::KINEMATIC) continue;
+            double speed = std::sqrt(bodies.vx[i] * bodies.vx[i] + bodies.vy[i] * bodies.vy[i]);
+            double rx = bodies.x[i] - origin.x;
+            double ry = bodies.y[i] - origin.y;
+            double r = std::sqrt(rx * rx + ry * ry);
+            momentumScale += bodies.mass[i] * speed;
+            angularMomentumScale += bodies.mass[i] * r * speed;
+        }
+        drift = ConservationDrift();
+        hasBaseline = true;
+    }
+    sample.externalImpulse = externalImpulse;
+    sample.externalAngularImpulse = externalAngularImpulse;
+    sample.externalWork = externalWork;
+
+    // Whatever changed since the previous sample wasn't integration error alone
+    if (!rebaseline && disturbed && !history.empty()) {
+        const ConservationSample& last = history.back();
+        baseline.energy += (sample.energy - sample.externalWork) - (last.energy - last.externalWork);
+        baseline.momentum += (sample.momentum - sample.externalImpulse) - (last.momentum - last.externalImpulse);
+        baseline.angularMomentum += (sample.angularMomentum - sample.externalAngularImpulse) -
+            (last.angularMomentum - last.externalAngularImpulse);
+        sample.disturbed = true;
+        drift.disturbedSamples++;
+    }
+
+    Vector2d momentumChange = sample.momentum - sample.externalImpulse - baseline.momentum;
+    drift.energy = relativeChange(sample.energy - sample.externalWork - baseline.energy, std::abs(baseline.energy));
+    drift.momentum = relativeChange(std::sqrt(momentumChange.x * momentumChange.x + momentumChange.y * momentumChange.y),
+        momentumScale);
+    drift.angularMomentum = relativeChange(sample.angularMomentum - sample.externalAngularImpulse - baseline.angularMomentum,
+        angularMomentumScale);
+    drift.maxEnergy = std::max(drift.maxEnergy, drift.energy);
+    drift.maxMomentum = std::max(drift.maxMomentum, drift.momentum);
+    drift.maxAngularMomentum = std::max(drift.maxAngularMomentum, drift.angularMomentum);
+    drift.samples++;
+
+    history.push_back(sample);
+    while (history.size() > capacity) {
+        history.pop_front();
+    }
+}
+
+void ConservationMonitor::resetBaseline()
+{
+    hasBaseline = false;
+    hasRates = false;
+    drift = ConservationDrift();
+    history.clear();
+    ticksUntilSample = 0;
+}
+
+void ConservationMonitor::setEnabled(bool enable)
+{
+    if (enable && !enabled) {
+        resetBaseline();
+    }
+    enabled = enable;
+}
+
+void ConservationMonitor::setCapacity(size_t samples)
+{
+    capacity = std::max<size_t>(samples, 1);
+    while (history.size() > capacity) {
+        history.pop_front();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+// ConservationMonitor.h
+#pragma once
+#include "BodyStore.h"
+#include "VectorHelper.h"
+#include <deque>
+
+// Conserved quantities of the simulated system at one simulation time. Pinned and prescribed
+// planets aren't moved by gravity, so their own motion is left out of the sums; what they give
+// the other bodies is kept separately, integrated from the baseline.
+struct ConservationSample {
+    double time = 0.0;
+    double kineticEnergy = 0.0;
+    double potentialEnergy = 0.0;
+    double energy = 0.0;
+    Vector2d momentum;
+    double angularMomentum = 0.0;   // About the reference point (z component; the game is 2D)
+
+    Vector2d externalImpulse;       // Pull of the kinematic planets on everything else
+    double externalAngularImpulse = 0.0;
+    double externalWork = 0.0;      // Done by prescribed planets moving through the potential
+    bool disturbed = false;         // Thrust or surface contact changed a rocket since the last sample
+};
+
+// Drift of the latest sample from the baseline, each relative to the quantity's own scale,
+// and the worst seen since the baseline was taken
+struct ConservationDrift {
+    double energy = 0.0;
+    double momentum = 0.0;
+    double angularMomentum = 0.0;
+    double maxEnergy = 0.0;
+    double maxMomentum = 0.0;
+    double maxAngularMomentum = 0.0;
+    size_t samples = 0;
+    size_t disturbedSamples = 0;        // Left out of the drift; see record
+};
+
+// Energy and momentum telemetry, for weighing timestep, integrator and approximation
+// settings against how much accuracy they cost. Samples are taken every few ticks and kept
+// in a bounded history; drift is measured against the first sample after a (re)baseline.
+class ConservationMonitor {
+private:
+    bool enabled = false;
+    int interval;                       // Ticks between samples
+    int ticksUntilSample = 0;
+    size_t capacity;
+    std::deque<ConservationSample> history;
+
+    bool hasBaseline = false;
+    ConservationSample baseline;
+    double momentumScale = 0.0;         // Sum of m |v| at the baseline
+    double angularMomentumScale = 0.0;  // Sum of m |r - origin| |v| at the baseline
+    size_t baselineBodies = 0;          // Body count and total mass the baseline was taken with
+    double baselineMass = 0.0;
+    Vector2d origin;                    // Heaviest body's position at the baseline
+    ConservationDrift drift;
+
+    // What the kinematic planets give the rest of the system per unit time
+    struct ExternalRates {
+        Vector2d force;
+        double torque = 0.0;
+        double power = 0.0;
+    };
+    bool hasRates = false;
+    ExternalRates lastRates;            // At the last accumulate, for the trapezoid rule
+    Vector2d externalImpulse;           // Integrated since the baseline
+    double externalAngularImpulse = 0.0;
+    double externalWork = 0.0;
+
+    static double relativeChange(double change, double scale);
+    static bool interacts(std::uint32_t a, std::uint32_t b, bool planetPairs, bool rocketPairs);
+    static ExternalRates measureExternal(const BodyStore& bodies, double G, bool planetPairs, bool rocketPairs,
+        const Vector2d& origin);
+
+public:
+    ConservationMonitor();
+
+    // Energy uses the exact pairwise potential whatever solver or cutoff the forces use,
+    // so approximations show up as drift. Planet-planet pairs count only with planet gravity
+    // on, rocket-rocket pairs only when rockets attract each other.
+    // Angular momentum is taken about origin; with the kinematic planets' torque accounted
+    // for, any fixed point works.
+    static ConservationSample measure(const BodyStore& bodies, double G, double time,
+        bool planetPairs, bool rocketPairs, const Vector2d& origin);
+
+    // Count a tick; true when this tick should be sampled
+    bool tick();
+    // Integrate the kinematic planets' impulse, torque and work over a tick of dt that ends
+    // with bodies. Called every tick while enabled, before any record for the same tick.
+    void accumulate(const BodyStore& bodies, double G, double dt, bool planetPairs, bool rocketPairs);
+    // Measure and add a sample; a change of body count or total mass starts a new baseline.
+    // A disturbed sample is flagged and its change since the previous sample is moved into
+    // the baseline, so work done by thrust and surface contact isn't counted as drift.
+    void record(const BodyStore& bodies, double G, double time, bool planetPairs, bool rocketPairs,
+        bool disturbed);
+    void resetBaseline();
+
+    void setEnabled(bool enable);
+    bool isEnabled() const { return enabled; }
+    void setInterval(int ticks) { interval = ticks > 0 ? ticks : 1; }
+    int getInterval() const { return interval; }
+    void setCapacity(size_t samples);
+
+    const std::deque<ConservationSample>& getHistory() const { return history; }
+    const ConservationSample& getBaseline() const { return baseline; }
+    const Vector2d& getOrigin() const { return origin; }
+    const ConservationDrift& getDrift() const { return drift; }
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+// DormandPrince.cpp
+#include "DormandPrince.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Step size controller: aim a little under the tolerance, and never change the step
+    // by more than these factors at once
+    constexpr double SAFETY = 0.9;
+    constexpr double MIN_SCALE = 0.2;
+    constexpr double MAX_SCALE = 5.0;
+}
+
+double DormandPrince::errorRatio(const State& error, double positionTolerance, double velocityTolerance)
+{
+    double positionError = std::sqrt(error.position.x * error.position.x + error.position.y * error.position.y);
+    double velocityError = std::sqrt(error.velocity.x * error.velocity.x + error.velocity.y * error.velocity.y);
+    return std::max(positionError / positionTolerance, velocityError / velocityTolerance);
+}
+
+double DormandPrince::nextStepSize(double step, double ratio)
+{
+    // The error estimate is fifth order in the step size
+    double scale = ratio > 0.0 ? SAFETY * std::pow(ratio, -0.2) : MAX_SCALE;
+    return step * std::max(MIN_SCALE, std::min(MAX_SCALE, scale));
+}
+
+Vector2d DormandPrince::positionAt(const State& a, const Vector2d& accelerationA, const State& b,
+    const Vector2d& accelerationB, double h, double u)
+{
+    double u2 = u * u;
+    double u3 = u2 * u;
+    double u4 = u3 * u;
+    double u5 = u4 * u;
+    double h0 = 1.0 - 10.0 * u3 + 15.0 * u4 - 6.0 * u5;
+    double h1 = (u - 6.0 * u3 + 8.0 * u4 - 3.0 * u5) * h;
+    double h2 = 0.5 * (u2 - 3.0 * u3 + 3.0 * u4 - u5) * h * h;
+    double h3 = (0.5 * u3 - u4 + 0.5 * u5) * h * h;
+    double h4 = (-4.0 * u3 + 7.0 * u4 - 3.0 * u5) * h;
+    double h5 = 10.0 * u3 - 15.0 * u4 + 6.0 * u5;
+    return a.position * h0 + a.velocity * h1 + accelerationA * h2 +
+        accelerationB * h3 + b.velocity * h4 + b.position * h5;
+}
\ No newline at end of file
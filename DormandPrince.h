@@ -0,0 +1,91 @@
+// DormandPrince.h
+#pragma once
+#include "VectorHelper.h"
+
+// Embedded Runge-Kutta 5(4) pair of Dormand and Prince for one body in a gravity field.
+// Each step gives a fifth order solution and a fourth order one; their difference is the
+// error estimate that sizes the next step. The last stage is the acceleration at the end of
+// the step, which is reused as the first stage of the next one (first same as last).
+namespace DormandPrince {
+    struct State {
+        Vector2d position;
+        Vector2d velocity;
+    };
+
+    // Largest error of a step relative to the position and velocity tolerances; a step is
+    // accepted when this is at most 1
+    double errorRatio(const State& error, double positionTolerance, double velocityTolerance);
+
+    // Size of the next attempt after a step with this error ratio, accepted or not
+    double nextStepSize(double step, double ratio);
+
+    // Take one step of size h from start, whose acceleration is startAcceleration. accelerate
+    // (position, time, acceleration) returns true if the position is inside a planet, in which
+    // case the step stops and returns false. On success end holds the fifth order state,
+    // endAcceleration its acceleration and error the difference from the fourth order one.
+    template <typename AccelerationFunction>
+    bool step(AccelerationFunction accelerate, double time, double h, const State& start,
+        const Vector2d& startAcceleration, State& end, Vector2d& endAcceleration, State& error);
+
+    // Position at fraction u of a step of length h from the states and accelerations at both
+    // ends: quintic Hermite, as accurate between the steps as the steps themselves
+    Vector2d positionAt(const State& a, const Vector2d& accelerationA, const State& b,
+        const Vector2d& accelerationB, double h, double u);
+}
+
+namespace DormandPrince {
+    namespace Tableau {
+        constexpr int STAGES = 7;
+        constexpr double C[STAGES] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0 };
+        constexpr double A[STAGES][STAGES - 1] = {
+            { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+            { 1.0 / 5.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+            { 3.0 / 40.0, 9.0 / 40.0, 0.0, 0.0, 0.0, 0.0 },
+            { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0, 0.0, 0.0, 0.0 },
+            { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0, 0.0, 0.0 },
+            { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0, 0.0 },
+            // The fifth order weights, so the last stage is evaluated at the new state
+            { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 }
+        };
+        // Fifth order weights minus fourth order weights
+        constexpr double E[STAGES] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0,
+            -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
+    }
+}
+
+template <typename AccelerationFunction>
+bool DormandPrince::step(AccelerationFunction accelerate, double time, double h, const State& start,
+    const Vector2d& startAcceleration, State& end, Vector2d& endAcceleration, State& error)
+{
+    using namespace Tableau;
+
+    // Derivatives at each stage: the position changes with the velocity, the velocity with gravity
+    Vector2d positionRate[STAGES];
+    Vector2d velocityRate[STAGES];
+    positionRate[0] = start.velocity;
+    velocityRate[0] = startAcceleration;
+
+    for (int s = 1; s < STAGES; s++) {
+        State stage = start;
+        for (int j = 0; j < s; j++) {
+            stage.position += positionRate[j] * (A[s][j] * h);
+            stage.velocity += velocityRate[j] * (A[s][j] * h);
+        }
+        if (accelerate(stage.position, time + C[s] * h, velocityRate[s])) {
+            return false;
+        }
+        positionRate[s] = stage.velocity;
+        if (s == STAGES - 1) {
+            end = stage;
+        }
+    }
+    endAcceleration = velocityRate[STAGES - 1];
+
+    error.position = Vector2d(0.0, 0.0);
+    error.velocity = Vector2d(0.0, 0.0);
+    for (int s = 0; s < STAGES; s++) {
+        error.position += positionRate[s] * (E[s] * h);
+        error.velocity += velocityRate[s] * (E[s] * h);
+    }
+    return true;
+}
\ No newline at end of file
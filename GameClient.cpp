@@ -33,6 +33,7 @@ void GameClient::initialize() {
         sf::Vector2f(GameConstants::MAIN_PLANET_X, GameConstants::MAIN_PLANET_Y),
         0, GameConstants::MAIN_PLANET_MASS, sf::Color::Blue);
     mainPlanet->setVelocity(sf::Vector2f(0.f, 0.f));
+    mainPlanet->setMotionSource(MotionSource::PINNED);
     planets.push_back(mainPlanet);
 
     // Create secondary planet
@@ -198,6 +199,7 @@ void GameClient::processGameState(const GameState& state) {
 
     for (int playerId : playersToRemove) {
         std::cout << "Remote player " << playerId << " disconnected" << std::endl;
+        simulator.removeVehicleManager(remotePlayers[playerId]);
         delete remotePlayers[playerId];
         remotePlayers.erase(playerId);
         remotePlayerStates.erase(playerId);
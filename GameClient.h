@@ -56,5 +56,6 @@ public:
 
     VehicleManager* getLocalPlayer() { return localPlayer; }
     const std::vector<Planet*>& getPlanets() const { return planets; }
+    GravitySimulator& getSimulator() { return simulator; }
     const std::map<int, VehicleManager*>& getRemotePlayers() const { return remotePlayers; }
 };
\ No newline at end of file
@@ -49,11 +49,65 @@ namespace GameConstants {
     constexpr float TRAJECTORY_TIME_STEP = 0.05f;
     constexpr int TRAJECTORY_STEPS = 5000;
     constexpr float TRAJECTORY_COLLISION_RADIUS = 10.0f;
+    constexpr double TRAJECTORY_SELF_INTERSECTION_SKIP = 4.0;  // Path length behind a point, in collision radii, that can't count as the path crossing itself
+    constexpr float TRAJECTORY_CACHE_TOLERANCE = 2.0f;  // Distance the rocket may stray from its cached path before it is recomputed
+    constexpr double TRAJECTORY_POSITION_TOLERANCE = 1e-4;  // Adaptive prediction: largest position error per step
+    constexpr double TRAJECTORY_VELOCITY_TOLERANCE = 1e-5;  // Adaptive prediction: largest velocity error per step
+    constexpr float TRAJECTORY_MAX_STEP = 5.0f;  // Adaptive prediction: longest step, so no small moon is stepped over
+    constexpr float TRAJECTORY_VERTEX_SPACING = 4.0f;  // Pixels between vertices of an adaptive path
+    constexpr double TRAJECTORY_MAX_VERTICES = 20000.0;  // Vertex budget of one path, whatever the zoom
+    constexpr double TRAJECTORY_CONIC_TOLERANCE = 0.25;  // Pixels a conic's chords may stray from the curve
+    constexpr double TRAJECTORY_CONIC_MAX_ANGLE = 0.1;  // Largest true anomaly step along a conic, in radians
+    constexpr double TRAJECTORY_CONIC_CHECK_DISTANCE = 50.0;  // Distance between sphere of influence checks along a conic
+    constexpr double POLYLINE_LOD_TOLERANCE = 0.5;  // Pixels a simplified path line may stray from the full one
+    constexpr float POLYLINE_LOD_MARGIN = 64.0f;  // Pixels beyond the view edges that path lines still cover
+    constexpr double ORBIT_PATH_TOLERANCE = 1.0;  // Pixels a planet's orbit may change shape before its cached line is rebuilt
+    constexpr double ORBIT_PATH_MAX_PERTURBATION = 0.01;  // Pull beyond the parent's, as a fraction of it, that still counts as a two-body orbit
+
+    // Fixed timestep simulation
+    constexpr float SIMULATION_TICK_RATE = 120.0f;  // Simulation steps per second
+    constexpr int MAX_SIMULATION_SUBSTEPS = 8;  // Steps per frame before the simulation slows down instead
+
+    // Planet ephemeris
+    constexpr float EPHEMERIS_SAMPLE_INTERVAL = 0.5f;  // Seconds between tabulated planet states
+    constexpr int EPHEMERIS_SUBSTEPS = 16;  // Yoshida 4 steps per sample interval
+    constexpr double EPHEMERIS_POSITION_TOLERANCE = 0.5;  // Distance a planet may be off the table before it is rebuilt, e.g. float network positions
+    constexpr double EPHEMERIS_VELOCITY_TOLERANCE = 0.05;  // Speed difference allowed the same way
+
+    // Conservation diagnostics
+    constexpr int DIAGNOSTICS_INTERVAL = 60;  // Simulation ticks between samples
+    constexpr int DIAGNOSTICS_HISTORY = 600;  // Samples kept in the time series
+
+    // Job system
+    constexpr int JOB_THREADS = 0;  // Threads in the shared pool, counting the caller (0 = one per hardware thread)
+    constexpr int GRAVITY_JOB_GRAIN = 64;  // Bodies per chunk of a force pass
+    constexpr int INTEGRATION_JOB_GRAIN = 4096;  // Bodies per chunk of a kick or drift
+    constexpr int PARTICLE_JOB_GRAIN = 4096;  // Particles per chunk of a particle kick
+    constexpr int BATCH_TRAJECTORY_JOB_GRAIN = 8;  // Rockets per chunk of a batched trajectory prediction
+    constexpr int BATCH_TRAJECTORY_BLOCK_STEPS = 64;  // Grid steps each of those chunks runs before the lanes are regrouped
+    constexpr int VEHICLE_JOB_GRAIN = 16;  // Players per chunk of the vehicle update
+
+    // Massless particles
+    constexpr int ASTEROID_BELT_PARTICLES = 100000;  // Particles added by the belt toggle
+    constexpr float ASTEROID_BELT_INNER_RADIUS = 900.0f;  // Around the main planet, well inside the moon's orbit
+    constexpr float ASTEROID_BELT_OUTER_RADIUS = 1500.0f;
+
+    // Barnes-Hut gravity solver
+    constexpr float BARNES_HUT_OPENING_ANGLE = 0.5f;  // Smaller is more accurate but slower
+    constexpr float BARNES_HUT_ERROR_TOLERANCE = 0.01f;  // RMS force error allowed at the default opening angle
+
+    // Rocket-rocket gravity broadphase
+    constexpr float ROCKET_GRAVITY_CUTOFF = 2000.0f;  // Rockets farther apart than this don't attract (0 = no cutoff)
 
     // Vehicle physics
     constexpr float FRICTION = 0.0098f;  // Friction coefficient for surface movement
     constexpr float TRANSFORM_DISTANCE = 30.0f;  // Distance for vehicle transformation
-    constexpr float ADAPTIVE_TIMESTEP_THRESHOLD = 10.0f;  // Threshold for adaptive timestep
+    constexpr float SLEEP_SPEED = 2.0f;  // Speed relative to the surface below which a grounded body is at rest
+    constexpr float SLEEP_DELAY = 0.5f;  // Seconds at rest with no input before a body sleeps
+    constexpr float SLEEP_WAKE_ACCELERATION = 0.1f;  // Planet acceleration change, as a fraction of surface gravity, that wakes a sleeper
+    constexpr float ADAPTIVE_TIMESTEP_THRESHOLD = 10.0f;  // Body steps are this fraction of |a| / |da/dt|
+    constexpr int MAX_TIMESTEP_LEVEL = 8;  // Finest block timestep is the simulation step / 2^8
+    constexpr int MAX_TIMESTEP_TICKS = 8;  // Longest block timestep, in simulation steps (a power of two)
     constexpr float CAR_WHEEL_RADIUS = 5.0f;  // Radius of car wheels
     constexpr float CAR_BODY_WIDTH = 30.0f;  // Width of car body
     constexpr float CAR_BODY_HEIGHT = 15.0f;  // Height of car body
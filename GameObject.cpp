@@ -1,21 +1,53 @@
 #include "GameObject.h"
 
+float GameObject::renderAlpha = 1.0f;
+Vector2d GameObject::renderOrigin(0.0, 0.0);
+
 GameObject::GameObject(sf::Vector2f pos, sf::Vector2f vel, sf::Color col)
-    : position(pos), velocity(vel), color(col)
+    : position(Vector2d(pos)), previousPosition(Vector2d(pos)), velocity(Vector2d(vel)), color(col)
 {
 }
 
 sf::Vector2f GameObject::getPosition() const
 {
-    return position;
+    return sf::Vector2f(position);
 }
 
 sf::Vector2f GameObject::getVelocity() const
 {
-    return velocity;
+    return sf::Vector2f(velocity);
 }
 
 void GameObject::setVelocity(sf::Vector2f vel)
 {
-    velocity = vel;
+    velocity = Vector2d(vel);
+}
+
+void GameObject::setWorldPosition(const Vector2d& pos)
+{
+    // A teleport - nothing to interpolate from
+    position = pos;
+    previousPosition = pos;
+}
+
+void GameObject::advanceTo(const Vector2d& pos)
+{
+    previousPosition = position;
+    position = pos;
+}
+
+Vector2d GameObject::getInterpolatedPosition() const
+{
+    return previousPosition + (position - previousPosition) * static_cast<double>(renderAlpha);
+}
+
+sf::Vector2f GameObject::getRenderPosition() const
+{
+    return toRenderSpace(getInterpolatedPosition());
+}
+
+sf::Vector2f GameObject::toRenderSpace(const Vector2d& world)
+{
+    // Subtract in double first, then the small remainder fits a float
+    return sf::Vector2f(world - renderOrigin);
 }
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include "VectorHelper.h"
 
 class GameObject {
 protected:
-    sf::Vector2f position;
-    sf::Vector2f velocity;
+    // Simulation state is double precision so planets far from the origin still move smoothly
+    Vector2d position;
+    Vector2d previousPosition;  // Position at the start of the last simulation step
+    Vector2d velocity;
     sf::Color color;
 
+    // Blend factor between previousPosition and position used when drawing
+    static float renderAlpha;
+    // World point drawn at (0, 0). Rendering happens relative to it so SFML only sees small floats.
+    static Vector2d renderOrigin;
+
 public:
     GameObject(sf::Vector2f pos, sf::Vector2f vel, sf::Color col);
     virtual ~GameObject() = default;
@@ -14,7 +22,28 @@ public:
     virtual void update(float deltaTime) = 0;
     virtual void draw(sf::RenderWindow& window) = 0;
 
+    // Single-precision copies for HUD, input and network code
     sf::Vector2f getPosition() const;
     sf::Vector2f getVelocity() const;
     void setVelocity(sf::Vector2f vel);
+
+    // Full-precision world state for the simulation
+    const Vector2d& getWorldPosition() const { return position; }
+    const Vector2d& getWorldVelocity() const { return velocity; }
+    void setWorldPosition(const Vector2d& pos);
+    void setWorldVelocity(const Vector2d& vel) { velocity = vel; }
+    // Move to the position reached by a simulation step, keeping the old one for interpolation
+    void advanceTo(const Vector2d& pos);
+
+    // World position interpolated between the last two simulation steps
+    Vector2d getInterpolatedPosition() const;
+    // Interpolated position relative to the render origin, for drawing only
+    sf::Vector2f getRenderPosition() const;
+
+    static void setRenderAlpha(float alpha) { renderAlpha = alpha; }
+    static float getRenderAlpha() { return renderAlpha; }
+    static void setRenderOrigin(const Vector2d& origin) { renderOrigin = origin; }
+    static const Vector2d& getRenderOrigin() { return renderOrigin; }
+    // Convert a world point into the coordinates handed to SFML
+    static sf::Vector2f toRenderSpace(const Vector2d& world);
 };
\ No newline at end of file
@@ -26,6 +26,7 @@ void GameServer::initialize() {
         sf::Vector2f(GameConstants::MAIN_PLANET_X, GameConstants::MAIN_PLANET_Y),
         0, GameConstants::MAIN_PLANET_MASS, sf::Color::Blue);
     mainPlanet->setVelocity(sf::Vector2f(0.f, 0.f));
+    mainPlanet->setMotionSource(MotionSource::PINNED);
     planets.push_back(mainPlanet);
 
     // Create secondary planet
@@ -83,10 +84,17 @@ void GameServer::update(float deltaTime) {
         planet->update(deltaTime);
     }
 
-    // Update all players
+    // Update all players - each only touches its own vehicles, so chunks of them run in parallel
+    playerList.clear();
     for (auto& pair : players) {
-        pair.second->update(deltaTime);
-    }
+        playerList.push_back(pair.second);
+    }
+    simulator.getJobSystem().parallelFor(playerList.size(), GameConstants::VEHICLE_JOB_GRAIN,
+        [this, deltaTime](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; p++) {
+                playerList[p]->update(deltaTime);
+            }
+        });
 
     // Increment sequence number
     sequenceNumber++;
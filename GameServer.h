@@ -12,6 +12,7 @@ private:
     GravitySimulator simulator;
     std::vector<Planet*> planets;
     std::map<int, VehicleManager*> players;
+    std::vector<VehicleManager*> playerList;    // Scratch: players in id order for the parallel update
     unsigned long sequenceNumber;
     float gameTime;
 
@@ -28,6 +29,7 @@ public:
     void removePlayer(int playerId);
 
     const std::vector<Planet*>& getPlanets() const { return planets; }
+    GravitySimulator& getSimulator() { return simulator; }
     VehicleManager* getPlayer(int playerId) {
         auto it = players.find(playerId);
         return (it != players.end()) ? it->second : nullptr;
@@ -0,0 +1,342 @@
+// GravityKernel.cpp
+#include "GravityKernel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GRAVITY_KERNEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions marked for it;
+// MSVC allows the intrinsics anywhere
+#if defined(GRAVITY_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GRAVITY_TARGET_SSE2 __attribute__((target("sse2")))
+#define GRAVITY_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define GRAVITY_TARGET_SSE2
+#define GRAVITY_TARGET_AVX2
+#endif
+
+namespace {
+    // Sources [begin, count) one at a time - also handles the tail of the SIMD loops
+    bool accumulateScalar(const GravitySources& sources, size_t begin, double px, double py, double G,
+        double exclusionRadius, double minDistance, double& ax, double& ay)
+    {
+        bool skipped = false;
+        for (size_t i = begin; i < sources.count; i++) {
+            double dx = sources.x[i] - px;
+            double dy = sources.y[i] - py;
+            double distanceSquared = dx * dx + dy * dy;
+            double limit = sources.radius[i] + exclusionRadius;
+
+            if (distanceSquared <= limit * limit) {
+                skipped = true;
+                continue;
+            }
+
+            double distance = std::sqrt(distanceSquared);
+            double clamped = std::max(distance, minDistance);
+            double scale = G * sources.mass[i] / (clamped * clamped * distance);
+            ax += dx * scale;
+            ay += dy * scale;
+        }
+        return skipped;
+    }
+
+    // Points [begin, count) one at a time - also handles the tail of the SIMD point loops
+    void accumulatePointsScalar(const GravitySources& sources, const double* px, const double* py,
+        size_t begin, size_t count, double G, double exclusionRadius, double* ax, double* ay, unsigned char* hit)
+    {
+        for (size_t p = begin; p < count; p++) {
+            if (accumulateScalar(sources, 0, px[p], py[p], G, exclusionRadius, 0.0, ax[p], ay[p]) && hit) {
+                hit[p] = 1;
+            }
+        }
+    }
+
+    void markSkippedLanes(int skippedLanes, size_t first, int lanes, unsigned char* hit)
+    {
+        if (!hit) return;
+        for (int lane = 0; lane < lanes; lane++) {
+            if (skippedLanes & (1 << lane)) {
+                hit[first + lane] = 1;
+            }
+        }
+    }
+
+#ifdef GRAVITY_KERNEL_X86
+    GRAVITY_TARGET_SSE2
+    void accumulatePointsSse2(const GravitySources& sources, const double* px, const double* py, size_t count,
+        double G, double exclusionRadius, double* ax, double* ay, unsigned char* hit)
+    {
+        const __m128d one = _mm_set1_pd(1.0);
+
+        size_t p = 0;
+        for (; p + 2 <= count; p += 2) {
+            const __m128d pointX = _mm_loadu_pd(px + p);
+            const __m128d pointY = _mm_loadu_pd(py + p);
+            __m128d sumX = _mm_loadu_pd(ax + p);
+            __m128d sumY = _mm_loadu_pd(ay + p);
+            int skippedLanes = 0;
+
+            // Sources are few, so each one is broadcast against a pair of points
+            for (size_t i = 0; i < sources.count; i++) {
+                __m128d dx = _mm_sub_pd(_mm_set1_pd(sources.x[i]), pointX);
+                __m128d dy = _mm_sub_pd(_mm_set1_pd(sources.y[i]), pointY);
+                __m128d distanceSquared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+                double limit = sources.radius[i] + exclusionRadius;
+                __m128d valid = _mm_cmpgt_pd(distanceSquared, _mm_set1_pd(limit * limit));
+                skippedLanes |= ~_mm_movemask_pd(valid) & 0x3;
+
+                __m128d safe = _mm_or_pd(_mm_and_pd(valid, distanceSquared), _mm_andnot_pd(valid, one));
+                __m128d distance = _mm_sqrt_pd(safe);
+                __m128d scale = _mm_div_pd(_mm_set1_pd(G * sources.mass[i]), _mm_mul_pd(safe, distance));
+                scale = _mm_and_pd(scale, valid);
+
+                sumX = _mm_add_pd(sumX, _mm_mul_pd(dx, scale));
+                sumY = _mm_add_pd(sumY, _mm_mul_pd(dy, scale));
+            }
+
+            _mm_storeu_pd(ax + p, sumX);
+            _mm_storeu_pd(ay + p, sumY);
+            markSkippedLanes(skippedLanes, p, 2, hit);
+        }
+
+        accumulatePointsScalar(sources, px, py, p, count, G, exclusionRadius, ax, ay, hit);
+    }
+
+    GRAVITY_TARGET_AVX2
+    void accumulatePointsAvx2(const GravitySources& sources, const double* px, const double* py, size_t count,
+        double G, double exclusionRadius, double* ax, double* ay, unsigned char* hit)
+    {
+        const __m256d one = _mm256_set1_pd(1.0);
+
+        size_t p = 0;
+        for (; p + 4 <= count; p += 4) {
+            const __m256d pointX = _mm256_loadu_pd(px + p);
+            const __m256d pointY = _mm256_loadu_pd(py + p);
+            __m256d sumX = _mm256_loadu_pd(ax + p);
+            __m256d sumY = _mm256_loadu_pd(ay + p);
+            int skippedLanes = 0;
+
+            for (size_t i = 0; i < sources.count; i++) {
+                __m256d dx = _mm256_sub_pd(_mm256_set1_pd(sources.x[i]), pointX);
+                __m256d dy = _mm256_sub_pd(_mm256_set1_pd(sources.y[i]), pointY);
+                __m256d distanceSquared = _mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy));
+                double limit = sources.radius[i] + exclusionRadius;
+                __m256d valid = _mm256_cmp_pd(distanceSquared, _mm256_set1_pd(limit * limit), _CMP_GT_OQ);
+                skippedLanes |= ~_mm256_movemask_pd(valid) & 0xF;
+
+                __m256d safe = _mm256_blendv_pd(one, distanceSquared, valid);
+                __m256d distance = _mm256_sqrt_pd(safe);
+                __m256d scale = _mm256_div_pd(_mm256_set1_pd(G * sources.mass[i]), _mm256_mul_pd(safe, distance));
+                scale = _mm256_and_pd(scale, valid);
+
+                sumX = _mm256_fmadd_pd(dx, scale, sumX);
+                sumY = _mm256_fmadd_pd(dy, scale, sumY);
+            }
+
+            _mm256_storeu_pd(ax + p, sumX);
+            _mm256_storeu_pd(ay + p, sumY);
+            markSkippedLanes(skippedLanes, p, 4, hit);
+        }
+
+        accumulatePointsScalar(sources, px, py, p, count, G, exclusionRadius, ax, ay, hit);
+    }
+
+    GRAVITY_TARGET_SSE2
+    bool accumulateSse2(const GravitySources& sources, double px, double py, double G,
+        double exclusionRadius, double minDistance, double& ax, double& ay)
+    {
+        const __m128d pointX = _mm_set1_pd(px);
+        const __m128d pointY = _mm_set1_pd(py);
+        const __m128d gravity = _mm_set1_pd(G);
+        const __m128d exclusion = _mm_set1_pd(exclusionRadius);
+        const __m128d minimum = _mm_set1_pd(minDistance);
+        const __m128d one = _mm_set1_pd(1.0);
+
+        __m128d sumX = _mm_setzero_pd();
+        __m128d sumY = _mm_setzero_pd();
+        int skippedLanes = 0;
+
+        size_t i = 0;
+        for (; i + 2 <= sources.count; i += 2) {
+            __m128d dx = _mm_sub_pd(_mm_loadu_pd(sources.x + i), pointX);
+            __m128d dy = _mm_sub_pd(_mm_loadu_pd(sources.y + i), pointY);
+            __m128d distanceSquared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+            __m128d limit = _mm_add_pd(_mm_loadu_pd(sources.radius + i), exclusion);
+            __m128d valid = _mm_cmpgt_pd(distanceSquared, _mm_mul_pd(limit, limit));
+            skippedLanes |= ~_mm_movemask_pd(valid) & 0x3;
+
+            // Replace skipped lanes with 1 so the sqrt and divide stay finite
+            __m128d safe = _mm_or_pd(_mm_and_pd(valid, distanceSquared), _mm_andnot_pd(valid, one));
+            __m128d distance = _mm_sqrt_pd(safe);
+            __m128d clamped = _mm_max_pd(distance, minimum);
+            __m128d scale = _mm_div_pd(_mm_mul_pd(gravity, _mm_loadu_pd(sources.mass + i)),
+                _mm_mul_pd(_mm_mul_pd(clamped, clamped), distance));
+            scale = _mm_and_pd(scale, valid);
+
+            sumX = _mm_add_pd(sumX, _mm_mul_pd(dx, scale));
+            sumY = _mm_add_pd(sumY, _mm_mul_pd(dy, scale));
+        }
+
+        double lanesX[2];
+        double lanesY[2];
+        _mm_storeu_pd(lanesX, sumX);
+        _mm_storeu_pd(lanesY, sumY);
+        ax += lanesX[0] + lanesX[1];
+        ay += lanesY[0] + lanesY[1];
+
+        bool skipped = accumulateScalar(sources, i, px, py, G, exclusionRadius, minDistance, ax, ay);
+        return skipped || skippedLanes != 0;
+    }
+
+    GRAVITY_TARGET_AVX2
+    bool accumulateAvx2(const GravitySources& sources, double px, double py, double G,
+        double exclusionRadius, double minDistance, double& ax, double& ay)
+    {
+        const __m256d pointX = _mm256_set1_pd(px);
+        const __m256d pointY = _mm256_set1_pd(py);
+        const __m256d gravity = _mm256_set1_pd(G);
+        const __m256d exclusion = _mm256_set1_pd(exclusionRadius);
+        const __m256d minimum = _mm256_set1_pd(minDistance);
+        const __m256d one = _mm256_set1_pd(1.0);
+
+        __m256d sumX = _mm256_setzero_pd();
+        __m256d sumY = _mm256_setzero_pd();
+        int skippedLanes = 0;
+
+        size_t i = 0;
+        for (; i + 4 <= sources.count; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(sources.x + i), pointX);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(sources.y + i), pointY);
+            __m256d distanceSquared = _mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy));
+            __m256d limit = _mm256_add_pd(_mm256_loadu_pd(sources.radius + i), exclusion);
+            __m256d valid = _mm256_cmp_pd(distanceSquared, _mm256_mul_pd(limit, limit), _CMP_GT_OQ);
+            skippedLanes |= ~_mm256_movemask_pd(valid) & 0xF;
+
+            // Replace skipped lanes with 1 so the sqrt and divide stay finite
+            __m256d safe = _mm256_blendv_pd(one, distanceSquared, valid);
+            __m256d distance = _mm256_sqrt_pd(safe);
+            __m256d clamped = _mm256_max_pd(distance, minimum);
+            __m256d scale = _mm256_div_pd(_mm256_mul_pd(gravity, _mm256_loadu_pd(sources.mass + i)),
+                _mm256_mul_pd(_mm256_mul_pd(clamped, clamped), distance));
+            scale = _mm256_and_pd(scale, valid);
+
+            sumX = _mm256_fmadd_pd(dx, scale, sumX);
+            sumY = _mm256_fmadd_pd(dy, scale, sumY);
+        }
+
+        // Fold four lanes down to two and reuse the SSE reduction order
+        __m128d foldX = _mm_add_pd(_mm256_castpd256_pd128(sumX), _mm256_extractf128_pd(sumX, 1));
+        __m128d foldY = _mm_add_pd(_mm256_castpd256_pd128(sumY), _mm256_extractf128_pd(sumY, 1));
+        double lanesX[2];
+        double lanesY[2];
+        _mm_storeu_pd(lanesX, foldX);
+        _mm_storeu_pd(lanesY, foldY);
+        ax += lanesX[0] + lanesX[1];
+        ay += lanesY[0] + lanesY[1];
+
+        bool skipped = accumulateScalar(sources, i, px, py, G, exclusionRadius, minDistance, ax, ay);
+        return skipped || skippedLanes != 0;
+    }
+#endif
+
+    SimdLevel detectSupportedLevel()
+    {
+#ifdef GRAVITY_KERNEL_X86
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool fma = (info[2] & (1 << 12)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+
+        bool avx2 = false;
+        if (maxLeaf >= 7) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        // The OS must also save the upper halves of the YMM registers
+        bool osSavesYmm = osxsave && (_xgetbv(0) & 6) == 6;
+
+        if (avx && avx2 && fma && osSavesYmm) return SimdLevel::AVX2;
+        if (sse2) return SimdLevel::SSE2;
+        return SimdLevel::SCALAR;
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+        return SimdLevel::SCALAR;
+#endif
+#else
+        return SimdLevel::SCALAR;
+#endif
+    }
+
+    SimdLevel& activeLevelStorage()
+    {
+        static SimdLevel level = GravityKernel::getSupportedLevel();
+        return level;
+    }
+}
+
+namespace GravityKernel {
+    bool accumulate(const GravitySources& sources, double px, double py, double G,
+        double exclusionRadius, double minDistance, double& ax, double& ay)
+    {
+        switch (activeLevelStorage()) {
+#ifdef GRAVITY_KERNEL_X86
+        case SimdLevel::AVX2:
+            return accumulateAvx2(sources, px, py, G, exclusionRadius, minDistance, ax, ay);
+        case SimdLevel::SSE2:
+            return accumulateSse2(sources, px, py, G, exclusionRadius, minDistance, ax, ay);
+#endif
+        default:
+            return accumulateScalar(sources, 0, px, py, G, exclusionRadius, minDistance, ax, ay);
+        }
+    }
+
+    void accumulateOnPoints(const GravitySources& sources, const double* px, const double* py, size_t count,
+        double G, double exclusionRadius, double* ax, double* ay, unsigned char* hit)
+    {
+        switch (activeLevelStorage()) {
+#ifdef GRAVITY_KERNEL_X86
+        case SimdLevel::AVX2:
+            accumulatePointsAvx2(sources, px, py, count, G, exclusionRadius, ax, ay, hit);
+            return;
+        case SimdLevel::SSE2:
+            accumulatePointsSse2(sources, px, py, count, G, exclusionRadius, ax, ay, hit);
+            return;
+#endif
+        default:
+            accumulatePointsScalar(sources, px, py, 0, count, G, exclusionRadius, ax, ay, hit);
+        }
+    }
+
+    SimdLevel getSupportedLevel()
+    {
+        static const SimdLevel supported = detectSupportedLevel();
+        return supported;
+    }
+
+    SimdLevel getActiveLevel()
+    {
+        return activeLevelStorage();
+    }
+
+    void setActiveLevel(SimdLevel level)
+    {
+        // Never select an instruction set the CPU does not have
+        activeLevelStorage() = std::min(level, getSupportedLevel());
+    }
+}
\ No newline at end of file
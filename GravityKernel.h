@@ -0,0 +1,48 @@
+// GravityKernel.h
+#pragma once
+#include <cstddef>
+
+// Structure-of-arrays view of the bodies that pull on a point
+struct GravitySources {
+    const double* x;
+    const double* y;
+    const double* mass;
+    const double* radius;
+    size_t count;
+};
+
+// Instruction sets the kernel can run on
+enum class SimdLevel {
+    SCALAR,
+    SSE2,   // 2 sources per instruction
+    AVX2    // 4 sources per instruction
+};
+
+// How body-body gravity is evaluated
+enum class GravitySolver {
+    PAIRWISE,    // Exact O(n^2) sum over every pair - the reference
+    BARNES_HUT   // Quadtree approximation, O(n log n)
+};
+
+namespace GravityKernel {
+    // Add the acceleration G * m / r^2 from every source onto (px, py).
+    // Sources closer than their radius plus exclusionRadius are skipped, and the
+    // distance used for the force magnitude is clamped to minDistance.
+    // Returns true if any source was skipped for being too close.
+    // Works in double precision so large coordinates keep their small differences.
+    bool accumulate(const GravitySources& sources, double px, double py, double G,
+        double exclusionRadius, double minDistance, double& ax, double& ay);
+
+    // The same sum for many points against few sources, vectorized across the points.
+    // Adds onto ax[p] / ay[p]; if hit isn't null, hit[p] is set to 1 for every point that
+    // had a source skipped. Used for massless particles, so there is no distance clamp.
+    void accumulateOnPoints(const GravitySources& sources, const double* px, const double* py, size_t count,
+        double G, double exclusionRadius, double* ax, double* ay, unsigned char* hit);
+
+    // Best level supported by this CPU, detected once on first use
+    SimdLevel getSupportedLevel();
+
+    // Level used by accumulate(); can be lowered to compare against the scalar path
+    SimdLevel getActiveLevel();
+    void setActiveLevel(SimdLevel level);
+}
\ No newline at end of file
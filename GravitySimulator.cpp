@@ -1,6 +1,9 @@
 // Update in GravitySimulator.cpp
 #include "GravitySimulator.h"
 #include "VehicleManager.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 void GravitySimulator::addPlanet(Planet* planet)
 {
@@ -12,120 +15,885 @@ void GravitySimulator::addRocket(Rocket* rocket)
     rockets.push_back(rocket);
 }
 
+void GravitySimulator::addVehicleManager(VehicleManager* manager)
+{
+    if (manager && std::find(vehicleManagers.begin(), vehicleManagers.end(), manager) == vehicleManagers.end()) {
+        vehicleManagers.push_back(manager);
+    }
+}
+
+void GravitySimulator::removeVehicleManager(VehicleManager* manager)
+{
+    vehicleManagers.erase(std::remove(vehicleManagers.begin(), vehicleManagers.end(), manager), vehicleManagers.end());
+}
+
 void GravitySimulator::clearRockets()
 {
     rockets.clear();
 }
 
-void GravitySimulator::addRocketGravityInteractions(float deltaTime)
+void GravitySimulator::gatherBodies()
 {
-    // Apply gravity between rockets
-    for (size_t i = 0; i < rockets.size(); i++) {
-        for (size_t j = i + 1; j < rockets.size(); j++) {
-            Rocket* rocket1 = rockets[i];
-            Rocket* rocket2 = rockets[j];
+    // Planets follow the table; rebuild it first if they were moved or changed mass
+    ephemeris.sync(planets, simulationTime, simulatePlanetGravity, solver, openingAngle);
+
+    // Decide which rockets take part in this step
+    storedRockets.clear();
+    railRockets.clear();
+    if (!vehicleManagers.empty()) {
+        std::vector<Rocket*>& candidates = candidateRockets;
+        candidates.clear();
+        for (auto manager : vehicleManagers) {
+            // Car gravity is handled internally in Car::update.
+            // Parked rockets ride along with their planet in Rocket::update.
+            if (manager->getActiveVehicleType() == VehicleType::ROCKET && manager->getRocket() &&
+                !manager->getRocket()->isSleeping()) {
+                candidates.push_back(manager->getRocket());
+            }
+        }
+
+        // Rockets close enough to pull on each other are found through the grid
+        const bool checkProximity = usesRails() && rocketGravity && candidates.size() > 1 && rocketGravityCutoff > 0.0;
+        if (checkProximity) {
+            candidateX.resize(candidates.size());
+            candidateY.resize(candidates.size());
+            for (size_t k = 0; k < candidates.size(); k++) {
+                candidateX[k] = candidates[k]->getWorldPosition().x;
+                candidateY[k] = candidates[k]->getWorldPosition().y;
+            }
+            rocketGrid.build(candidateX.data(), candidateY.data(), candidates.size(), rocketGravityCutoff);
+        }
 
-            sf::Vector2f direction = rocket2->getPosition() - rocket1->getPosition();
-            float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        storedRockets.reserve(candidates.size());
+        for (size_t k = 0; k < candidates.size(); k++) {
+            Rocket* rocket = candidates[k];
 
-            // Minimum distance to prevent extreme forces when very close
-            const float minDistance = GameConstants::TRAJECTORY_COLLISION_RADIUS;
-            if (distance < minDistance) {
-                distance = minDistance;
+            // Rockets still exactly where their rails left them are coasting and stay analytic;
+            // thrust, surface contact or a teleport changes the state and drops them back to numeric,
+            // and so does another rocket coming near enough to pull on them
+            auto entry = rails.find(rocket);
+            bool alone = !rocketGravity || candidates.size() == 1 || (checkProximity && !hasRocketNearby(k));
+            if (usesRails() && alone && entry != rails.end() &&
+                entry->second.lastPosition == rocket->getWorldPosition() &&
+                entry->second.lastVelocity == rocket->getWorldVelocity()) {
+                railRockets.push_back(rocket);
+            }
+            else {
+                storedRockets.push_back(rocket);
+            }
+        }
+    }
+    else {
+        // Legacy code for handling individual rockets; parked ones ride along with their planet
+        for (Rocket* rocket : rockets) {
+            if (!rocket->isSleeping()) {
+                storedRockets.push_back(rocket);
             }
+        }
+    }
 
-            // Apply inverse square law for gravity
-            float forceMagnitude = G * rocket1->getMass() * rocket2->getMass() / (distance * distance);
+    bodies.clear();
+    bodies.reserve(planets.size() + storedRockets.size());
 
-            sf::Vector2f normalizedDir = normalize(direction);
-            sf::Vector2f accel1 = normalizedDir * forceMagnitude / rocket1->getMass();
-            sf::Vector2f accel2 = -normalizedDir * forceMagnitude / rocket2->getMass();
+    for (size_t i = 0; i < planets.size(); i++) {
+        const Planet* planet = planets[i];
+        const Vector2d& pos = planet->getWorldPosition();
+        const Vector2d& vel = planet->getWorldVelocity();
 
-            rocket1->setVelocity(rocket1->getVelocity() + accel1 * deltaTime);
-            rocket2->setVelocity(rocket2->getVelocity() + accel2 * deltaTime);
+        std::uint32_t flags = BodyFlags::PLANET;
+        if (planet->getMotionSource() == MotionSource::PINNED) {
+            flags |= BodyFlags::PINNED;
         }
+        else if (planet->getMotionSource() == MotionSource::PRESCRIBED) {
+            flags |= BodyFlags::PRESCRIBED;
+        }
+        bodies.add(pos.x, pos.y, vel.x, vel.y, planet->getMass(), planet->getRadius(), flags);
+    }
+
+    rocketBegin = bodies.size();
+    for (const Rocket* rocket : storedRockets) {
+        const Vector2d& pos = rocket->getWorldPosition();
+        const Vector2d& vel = rocket->getWorldVelocity();
+        bodies.add(pos.x, pos.y, vel.x, vel.y, rocket->getMass(), 0.0f, BodyFlags::ROCKET);
     }
 }
 
-void GravitySimulator::update(float deltaTime)
+bool GravitySimulator::hasRocketNearby(size_t candidate) const
 {
-    // Apply gravity between planets if enabled
-    if (simulatePlanetGravity) {
-        for (size_t i = 0; i < planets.size(); i++) {
-            for (size_t j = i + 1; j < planets.size(); j++) {
-                Planet* planet1 = planets[i];
-                Planet* planet2 = planets[j];
-
-                // Skip the first planet (index 0) - it's pinned in place
-                if (i == 0) {
-                    // Only apply gravity from planet1 to planet2
-                    sf::Vector2f direction = planet1->getPosition() - planet2->getPosition();
-                    float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                    if (distance > planet1->getRadius() + planet2->getRadius()) {
-                        float forceMagnitude = G * planet1->getMass() * planet2->getMass() / (distance * distance);
-                        sf::Vector2f normalizedDir = normalize(direction);
-                        sf::Vector2f accel2 = normalizedDir * forceMagnitude / planet2->getMass();
-                        planet2->setVelocity(planet2->getVelocity() + accel2 * deltaTime);
-                    }
-                }
-                else {
-                    // Regular gravity calculation between other planets
-                    sf::Vector2f direction = planet2->getPosition() - planet1->getPosition();
-                    float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                    if (distance > planet1->getRadius() + planet2->getRadius()) {
-                        float forceMagnitude = G * planet1->getMass() * planet2->getMass() / (distance * distance);
-                        sf::Vector2f normalizedDir = normalize(direction);
-                        sf::Vector2f accel1 = normalizedDir * forceMagnitude / planet1->getMass();
-                        sf::Vector2f accel2 = -normalizedDir * forceMagnitude / planet2->getMass();
-                        planet1->setVelocity(planet1->getVelocity() + accel1 * deltaTime);
-                        planet2->setVelocity(planet2->getVelocity() + accel2 * deltaTime);
-                    }
-                }
+    const double px = candidateX[candidate];
+    const double py = candidateY[candidate];
+    const double cutoffSquared = rocketGravityCutoff * rocketGravityCutoff;
+    bool nearby = false;
+    rocketGrid.forEachNear(px, py, rocketGravityCutoff, [&](int other) {
+        double dx = candidateX[other] - px;
+        double dy = candidateY[other] - py;
+        if (static_cast<size_t>(other) != candidate && dx * dx + dy * dy <= cutoffSquared) {
+            nearby = true;
+        }
+    });
+    return nearby;
+}
+
+void GravitySimulator::placePlanets(double time)
+{
+    for (size_t j = 0; j < planets.size(); j++) {
+        Vector2d position;
+        Vector2d velocity;
+        ephemeris.stateAt(j, time, position, velocity);
+        bodies.x[j] = position.x;
+        bodies.y[j] = position.y;
+        bodies.vx[j] = velocity.x;
+        bodies.vy[j] = velocity.y;
+    }
+}
+
+void GravitySimulator::scatterState()
+{
+    for (size_t i = 0; i < planets.size(); i++) {
+        planets[i]->advanceTo(Vector2d(bodies.x[i], bodies.y[i]));
+        planets[i]->setWorldVelocity(Vector2d(bodies.vx[i], bodies.vy[i]));
+    }
+    for (size_t r = 0; r < storedRockets.size(); r++) {
+        size_t i = rocketBegin + r;
+        storedRockets[r]->advanceTo(Vector2d(bodies.x[i], bodies.y[i]));
+        storedRockets[r]->setWorldVelocity(Vector2d(bodies.vx[i], bodies.vy[i]));
+    }
+}
+
+void GravitySimulator::accumulateRocketGravityWithCutoff(const size_t* targets, size_t count)
+{
+    const size_t begin = rocketBegin;
+    const double cutoffSquared = rocketGravityCutoff * rocketGravityCutoff;
+
+    // Scratch for the rockets near the current target, one per thread
+    static thread_local BodyStore neighbours;
+
+    for (size_t t = 0; t < count; t++) {
+        size_t r = targets[t];
+        const double px = bodies.x[r];
+        const double py = bodies.y[r];
+
+        // Pack the rockets within the cutoff and hand them to the same kernel as the full sum
+        neighbours.clear();
+        rocketGrid.forEachNear(px, py, rocketGravityCutoff, [&](int other) {
+            size_t i = begin + other;
+            double dx = bodies.x[i] - px;
+            double dy = bodies.y[i] - py;
+            if (dx * dx + dy * dy <= cutoffSquared) {
+                neighbours.add(bodies.x[i], bodies.y[i], 0.0, 0.0, bodies.mass[i], 0.0, BodyFlags::ROCKET);
+            }
+        });
+
+        // The target itself is coincident and skipped by the kernel
+        GravitySources sources = { neighbours.x.data(), neighbours.y.data(), neighbours.mass.data(),
+            neighbours.radius.data(), neighbours.size() };
+        GravityKernel::accumulate(sources, px, py, G, 0.0, GameConstants::TRAJECTORY_COLLISION_RADIUS,
+            accelX[r], accelY[r]);
+    }
+}
+
+void GravitySimulator::buildRocketGravity()
+{
+    const size_t begin = rocketBegin;
+    const size_t count = bodies.size() - begin;
+    if (usesRocketGrid()) {
+        rocketGrid.build(bodies.x.data() + begin, bodies.y.data() + begin, count, rocketGravityCutoff);
+    }
+    else if (solver == GravitySolver::BARNES_HUT) {
+        std::vector<double> radii(count, 0.0);
+        rocketTree.setOpeningAngle(openingAngle);
+        rocketTree.build(bodies.x.data() + begin, bodies.y.data() + begin, bodies.mass.data() + begin, radii.data(), count);
+    }
+}
+
+void GravitySimulator::accumulateRocketGravity(const size_t* targets, size_t count)
+{
+    // Nearby rockets only - far pairs contribute next to nothing
+    if (usesRocketGrid()) {
+        accumulateRocketGravityWithCutoff(targets, count);
+        return;
+    }
+
+    // Minimum distance to prevent extreme forces when very close
+    const double minDistance = GameConstants::TRAJECTORY_COLLISION_RADIUS;
+
+    const size_t begin = rocketBegin;
+    const size_t end = bodies.size();
+    const double* x = bodies.x.data();
+    const double* y = bodies.y.data();
+    const double* mass = bodies.mass.data();
+
+    if (solver == GravitySolver::BARNES_HUT) {
+        for (size_t t = 0; t < count; t++) {
+            size_t r = targets[t];
+            Vector2d acceleration = rocketTree.accelerationAt(Vector2d(x[r], y[r]), G,
+                static_cast<int>(r - begin), 0.0, minDistance);
+            accelX[r] += acceleration.x;
+            accelY[r] += acceleration.y;
+        }
+        return;
+    }
+
+    // Gravity between rockets - coincident rockets are skipped by the kernel
+    GravitySources sources = { x + begin, y + begin, mass + begin, bodies.radius.data() + begin, end - begin };
+    for (size_t t = 0; t < count; t++) {
+        size_t r = targets[t];
+        GravityKernel::accumulate(sources, x[r], y[r], G, 0.0, minDistance, accelX[r], accelY[r]);
+    }
+}
+
+void GravitySimulator::buildPlanetTree()
+{
+    planetTree.setOpeningAngle(openingAngle);
+    planetTree.build(bodies.x.data(), bodies.y.data(), bodies.mass.data(), bodies.radius.data(), planets.size());
+}
+
+GravitySources GravitySimulator::getPlanetSources() const
+{
+    return { bodies.x.data(), bodies.y.data(), bodies.mass.data(), bodies.radius.data(), planets.size() };
+}
+
+void GravitySimulator::accumulatePlanetGravityOnRockets(const size_t* targets, size_t count)
+{
+    GravitySources sources = getPlanetSources();
+
+    for (size_t t = 0; t < count; t++) {
+        size_t r = targets[t];
+        if (solver == GravitySolver::BARNES_HUT) {
+            Vector2d acceleration = planetTree.accelerationAt(Vector2d(bodies.x[r], bodies.y[r]), G, -1,
+                GameConstants::TRAJECTORY_COLLISION_RADIUS);
+            accelX[r] += acceleration.x;
+            accelY[r] += acceleration.y;
+        }
+        else {
+            // Planets closer than their radius plus the collision radius are skipped
+            GravityKernel::accumulate(sources, bodies.x[r], bodies.y[r], G,
+                GameConstants::TRAJECTORY_COLLISION_RADIUS, 0.0, accelX[r], accelY[r]);
+        }
+    }
+}
+
+void GravitySimulator::computeAccelerations(const std::vector<size_t>& targets)
+{
+    if (targets.empty()) {
+        return;
+    }
+    forceEvaluations += targets.size();
+
+    for (size_t i : targets) {
+        accelX[i] = 0.0;
+        accelY[i] = 0.0;
+    }
+
+    // Only rockets are ever targets: the planets are placed from the ephemeris, which
+    // integrates their pull on each other itself
+    const size_t* rocketTargets = targets.data();
+    size_t rocketCount = targets.size();
+
+    // The tree is built once from the current positions and shared by every chunk
+    if (solver == GravitySolver::BARNES_HUT) {
+        buildPlanetTree();
+    }
+
+    if (rocketGravity) {
+        buildRocketGravity();
+    }
+
+    // Every target's sum is formed whole inside one chunk, in the same order as a serial
+    // pass, so the accelerations are bit-identical whatever the number of threads
+
+    // Planet gravity on every player's active rocket (or the legacy rockets), then rocket-to-rocket gravity
+    jobs->parallelFor(rocketCount, GameConstants::GRAVITY_JOB_GRAIN, [&](size_t begin, size_t end) {
+        accumulatePlanetGravityOnRockets(rocketTargets + begin, end - begin);
+        if (rocketGravity) {
+            accumulateRocketGravity(rocketTargets + begin, end - begin);
+        }
+    });
+}
+
+void GravitySimulator::kick(float deltaTime)
+{
+    computeAccelerations(steppedBodies);
+    jobs->parallelFor(steppedBodies.size(), GameConstants::INTEGRATION_JOB_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            size_t i = steppedBodies[t];
+            bodies.vx[i] += accelX[i] * deltaTime;
+            bodies.vy[i] += accelY[i] * deltaTime;
+        }
+    });
+}
+
+void GravitySimulator::drift(float deltaTime)
+{
+    jobs->parallelFor(steppedBodies.size(), GameConstants::INTEGRATION_JOB_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            size_t i = steppedBodies[t];
+            bodies.x[i] += bodies.vx[i] * deltaTime;
+            bodies.y[i] += bodies.vy[i] * deltaTime;
+        }
+    });
+
+    // The planets are wherever the table says they are by the end of this drift
+    stageTime += deltaTime;
+    placePlanets(stageTime);
+}
+
+double GravitySimulator::getJerkTimescale(size_t i) const
+{
+    // Only planets contribute - they dominate every rocket's acceleration
+    const double exclusion = GameConstants::TRAJECTORY_COLLISION_RADIUS;
+
+    double jx = 0.0;
+    double jy = 0.0;
+    for (size_t j = 0; j < planets.size(); j++) {
+        double dx = bodies.x[j] - bodies.x[i];
+        double dy = bodies.y[j] - bodies.y[i];
+        double distanceSquared = dx * dx + dy * dy;
+        double reach = bodies.radius[j] + exclusion;
+        if (distanceSquared <= reach * reach) continue;
+
+        // d/dt (G m r / |r|^3) = G m (v / |r|^3 - 3 (r.v) r / |r|^5)
+        double dvx = bodies.vx[j] - bodies.vx[i];
+        double dvy = bodies.vy[j] - bodies.vy[i];
+        double invDistance = 1.0 / std::sqrt(distanceSquared);
+        double invCube = invDistance * invDistance * invDistance;
+        double radialRate = 3.0 * (dx * dvx + dy * dvy) / distanceSquared;
+        double scale = G * bodies.mass[j] * invCube;
+        jx += scale * (dvx - radialRate * dx);
+        jy += scale * (dvy - radialRate * dy);
+    }
+
+    double jerk = std::sqrt(jx * jx + jy * jy);
+    double acceleration = std::sqrt(accelX[i] * accelX[i] + accelY[i] * accelY[i]);
+    if (jerk <= 0.0 || acceleration <= 0.0) {
+        return -1.0;
+    }
+    return acceleration / jerk;
+}
+
+int GravitySimulator::assignTimestepLevels(float deltaTime)
+{
+    timestepLevels.assign(bodies.size(), 0);
+    int maxLevel = 0;
+
+    for (size_t i : steppedBodies) {
+        // A body part-way through a step of several ticks keeps it
+        if (stepTicksLeft[i] < stepTicks[i]) continue;
+
+        // Bodies whose acceleration doesn't change at all may take the longest step
+        double timescale = getJerkTimescale(i);
+        double desiredStep = timescale > 0.0 ? timescale / GameConstants::ADAPTIVE_TIMESTEP_THRESHOLD :
+            std::numeric_limits<double>::infinity();
+
+        // Steps longer than a tick only double while the tick count is a multiple of the new
+        // length, so bodies on equal steps open and close on the same ticks
+        int ticks = 1;
+        while (ticks < GameConstants::MAX_TIMESTEP_TICKS && 2.0 * ticks * deltaTime <= desiredStep &&
+            blockTick % (2 * ticks) == 0) {
+            ticks *= 2;
+        }
+        if (ticks > 1) {
+            stepTicks[i] = ticks;
+            stepTicksLeft[i] = ticks;
+            continue;
+        }
+
+        int level = 0;
+        while (level < GameConstants::MAX_TIMESTEP_LEVEL && deltaTime / (1 << level) > desiredStep) {
+            level++;
+        }
+
+        timestepLevels[i] = level;
+        maxLevel = std::max(maxLevel, level);
+    }
+
+    return maxLevel;
+}
+
+void GravitySimulator::restoreHalfKick(size_t i, const BlockStep& step)
+{
+    Vector2d velocity(bodies.vx[i], bodies.vy[i]);
+    Vector2d restored = velocity == step.lastVelocity ? step.halfKickedVelocity :
+        velocity + (step.halfKickedVelocity - step.lastVelocity);
+    bodies.vx[i] = restored.x;
+    bodies.vy[i] = restored.y;
+}
+
+void GravitySimulator::endBlockStepEarly(size_t i, const Vector2d& opening, int ticks, int ticksLeft, float deltaTime)
+{
+    // The opening kick was for the whole step: take back the part that was never drifted,
+    // then close with the acceleration here
+    double done = static_cast<double>(ticks - ticksLeft) * deltaTime;
+    double skipped = static_cast<double>(ticksLeft) * deltaTime;
+    bodies.vx[i] += 0.5 * (accelX[i] * done - opening.x * skipped);
+    bodies.vy[i] += 0.5 * (accelY[i] * done - opening.y * skipped);
+}
+
+void GravitySimulator::resumeBlockSteps(float deltaTime)
+{
+    stepTicks.assign(bodies.size(), 1);
+    stepTicksLeft.assign(bodies.size(), 1);
+
+    // Accelerations carry over from the last closing kicks. Only bodies new to the hierarchy,
+    // or moved since by contact or a teleport, need fresh ones - all of them if the planets
+    // were changed under them. A long step also ends early when thrust changed the velocity.
+    const bool planetsChanged = ephemeris.getRevision() != blockRevision;
+    std::vector<size_t> refresh;
+    std::vector<size_t> interrupted;
+    std::vector<Vector2d> openings;
+    for (size_t i : steppedBodies) {
+        auto entry = blockSteps.find(storedRockets[i - rocketBegin]);
+        if (entry == blockSteps.end()) {
+            refresh.push_back(i);
+            continue;
+        }
+
+        const BlockStep& step = entry->second;
+        bool moved = planetsChanged || step.lastPosition != Vector2d(bodies.x[i], bodies.y[i]);
+        if (step.ticksLeft > 0) {
+            moved = moved || step.lastVelocity != Vector2d(bodies.vx[i], bodies.vy[i]);
+            restoreHalfKick(i, step);
+        }
+        if (moved) {
+            refresh.push_back(i);
+            if (step.ticksLeft > 0) {
+                interrupted.push_back(i);
+                openings.push_back(step.acceleration);
+                stepTicks[i] = step.ticks;
+                stepTicksLeft[i] = step.ticksLeft;
+            }
+            continue;
+        }
+
+        accelX[i] = step.acceleration.x;
+        accelY[i] = step.acceleration.y;
+        if (step.ticksLeft > 0) {
+            stepTicks[i] = step.ticks;
+            stepTicksLeft[i] = step.ticksLeft;
+        }
+    }
+    computeAccelerations(refresh);
+
+    // A long step whose body was moved ends where it was moved to
+    for (size_t k = 0; k < interrupted.size(); k++) {
+        size_t i = interrupted[k];
+        endBlockStepEarly(i, openings[k], stepTicks[i], stepTicksLeft[i], deltaTime);
+        stepTicks[i] = 1;
+        stepTicksLeft[i] = 1;
+    }
+}
+
+void GravitySimulator::closeBlockSteps(float deltaTime)
+{
+    if (blockSteps.empty()) return;
+
+    std::vector<size_t> open;
+    std::vector<const BlockStep*> steps;
+    for (size_t i : steppedBodies) {
+        auto entry = blockSteps.find(storedRockets[i - rocketBegin]);
+        if (entry != blockSteps.end() && entry->second.ticksLeft > 0) {
+            open.push_back(i);
+            steps.push_back(&entry->second);
+        }
+    }
+    computeAccelerations(open);
+    for (size_t k = 0; k < open.size(); k++) {
+        restoreHalfKick(open[k], *steps[k]);
+        endBlockStepEarly(open[k], steps[k]->acceleration, steps[k]->ticks, steps[k]->ticksLeft, deltaTime);
+    }
+    blockSteps.clear();
+}
+
+void GravitySimulator::updateBlockTimesteps(float deltaTime)
+{
+    resumeBlockSteps(deltaTime);
+    const int maxLevel = assignTimestepLevels(deltaTime);
+    const int substeps = 1 << maxLevel;
+    const float finestStep = deltaTime / substeps;
+
+    // Half of a body's own step, for its opening and closing kicks
+    auto halfStepOf = [&](size_t i) {
+        return stepTicks[i] > 1 ? 0.5 * deltaTime * stepTicks[i] : 0.5 * deltaTime / (1 << timestepLevels[i]);
+    };
+
+    std::vector<size_t> due;
+    due.reserve(steppedBodies.size());
+
+    for (int s = 0; s < substeps; s++) {
+        // Opening half kick for every body starting one of its own steps now
+        for (size_t i : steppedBodies) {
+            int stride = 1 << (maxLevel - timestepLevels[i]);
+            bool opens = stepTicks[i] > 1 ? s == 0 && stepTicksLeft[i] == stepTicks[i] : s % stride == 0;
+            if (opens) {
+                double halfStep = halfStepOf(i);
+                bodies.vx[i] += accelX[i] * halfStep;
+                bodies.vy[i] += accelY[i] * halfStep;
             }
         }
+
+        drift(finestStep);
+
+        // Only bodies finishing their step get new forces, then the closing half kick.
+        // Those accelerations are reused by the next opening kick, in this update or the next.
+        due.clear();
+        for (size_t i : steppedBodies) {
+            int stride = 1 << (maxLevel - timestepLevels[i]);
+            bool closes = stepTicks[i] > 1 ? s == substeps - 1 && stepTicksLeft[i] == 1 : (s + 1) % stride == 0;
+            if (closes) {
+                due.push_back(i);
+            }
+        }
+        computeAccelerations(due);
+        for (size_t i : due) {
+            double halfStep = halfStepOf(i);
+            bodies.vx[i] += accelX[i] * halfStep;
+            bodies.vy[i] += accelY[i] * halfStep;
+        }
+    }
+
+    // Carry each rocket's acceleration and open step over to the next update. A rocket still
+    // in a long step is written out with its velocity now rather than the half-kicked one:
+    // the opening kick less the part of the step not drifted yet.
+    std::unordered_map<const Rocket*, BlockStep> next;
+    for (size_t i : steppedBodies) {
+        BlockStep& step = next[storedRockets[i - rocketBegin]];
+        step.acceleration = Vector2d(accelX[i], accelY[i]);
+        step.lastPosition = Vector2d(bodies.x[i], bodies.y[i]);
+        step.ticks = stepTicks[i];
+        step.ticksLeft = stepTicksLeft[i] - 1;
+        if (step.ticksLeft > 0) {
+            step.halfKickedVelocity = Vector2d(bodies.vx[i], bodies.vy[i]);
+            double ahead = (0.5 * step.ticks - (step.ticks - step.ticksLeft)) * deltaTime;
+            bodies.vx[i] -= accelX[i] * ahead;
+            bodies.vy[i] -= accelY[i] * ahead;
+        }
+        step.lastVelocity = Vector2d(bodies.vx[i], bodies.vy[i]);
+    }
+    blockSteps.swap(next);
+    blockRevision = ephemeris.getRevision();
+    blockTick++;
+}
+
+void GravitySimulator::findSpheresOfInfluence()
+{
+    // The most massive planet is the root; every other planet's sphere of influence
+    // is a (m / M)^0.4 of its distance to it
+    rootBody = -1;
+    for (size_t j = 0; j < planets.size(); j++) {
+        if (rootBody < 0 || bodies.mass[j] > bodies.mass[rootBody]) {
+            rootBody = static_cast<int>(j);
+        }
+    }
+
+    soiRadius.assign(planets.size(), 0.0);
+    for (size_t j = 0; j < planets.size(); j++) {
+        if (static_cast<int>(j) == rootBody) continue;
+        double dx = bodies.x[j] - bodies.x[rootBody];
+        double dy = bodies.y[j] - bodies.y[rootBody];
+        soiRadius[j] = std::sqrt(dx * dx + dy * dy) * std::pow(bodies.mass[j] / bodies.mass[rootBody], 0.4);
+    }
+}
+
+int GravitySimulator::findDominantBody(const Vector2d& point) const
+{
+    // Innermost sphere of influence containing the point, else the root
+    int dominant = rootBody;
+    double smallest = 0.0;
+    for (size_t j = 0; j < planets.size(); j++) {
+        if (static_cast<int>(j) == rootBody) continue;
+        double dx = point.x - bodies.x[j];
+        double dy = point.y - bodies.y[j];
+        if (dx * dx + dy * dy < soiRadius[j] * soiRadius[j] && (dominant == rootBody || soiRadius[j] < smallest)) {
+            dominant = static_cast<int>(j);
+            smallest = soiRadius[j];
+        }
+    }
+    return dominant;
+}
+
+bool GravitySimulator::fitRails(const Rocket* rocket, RocketRails& entry) const
+{
+    const Vector2d& pos = rocket->getWorldPosition();
+    const Vector2d& vel = rocket->getWorldVelocity();
+    int central = findDominantBody(pos);
+    if (central < 0) return false;
+
+    // Inside the collision radius the numeric passes switch gravity off, so rails would disagree
+    Vector2d relative = pos - Vector2d(bodies.x[central], bodies.y[central]);
+    double limit = bodies.radius[central] + GameConstants::TRAJECTORY_COLLISION_RADIUS;
+    if (relative.x * relative.x + relative.y * relative.y <= limit * limit) return false;
+
+    Vector2d relativeVelocity = vel - Vector2d(bodies.vx[central], bodies.vy[central]);
+    entry.orbit = KeplerOrbit(relative, relativeVelocity, G * bodies.mass[central], simulationTime);
+    entry.centralBody = central;
+    entry.lastPosition = pos;
+    entry.lastVelocity = vel;
+    return true;
+}
+
+void GravitySimulator::updateRails()
+{
+    std::unordered_map<const Rocket*, RocketRails> next;
+    if (!usesRails() || planets.empty()) {
+        rails.swap(next);
+        return;
+    }
+
+    findSpheresOfInfluence();
+
+    // Coasting rockets: place them on their conic relative to the central planet's new state
+    for (Rocket* rocket : railRockets) {
+        RocketRails entry = rails[rocket];
+        int central = entry.centralBody;
+
+        Vector2d relative;
+        Vector2d relativeVelocity;
+        entry.orbit.stateAt(simulationTime, relative, relativeVelocity);
+        Vector2d pos = Vector2d(bodies.x[central], bodies.y[central]) + relative;
+        Vector2d vel = Vector2d(bodies.vx[central], bodies.vy[central]) + relativeVelocity;
+        rocket->advanceTo(pos);
+        rocket->setWorldVelocity(vel);
+
+        // Leaving the sphere of influence or reaching the surface ends the conic;
+        // the next step integrates numerically and refits around the new body
+        double limit = bodies.radius[central] + GameConstants::TRAJECTORY_COLLISION_RADIUS;
+        if (findDominantBody(pos) == central && relative.x * relative.x + relative.y * relative.y > limit * limit) {
+            entry.lastPosition = pos;
+            entry.lastVelocity = vel;
+            next[rocket] = entry;
+        }
+    }
+
+    // Numerically stepped rockets get fresh rails, used if nothing disturbs them before the next step.
+    // One part-way through a block step of several ticks has a half-kicked velocity, so it waits
+    // until that step closes.
+    for (Rocket* rocket : storedRockets) {
+        auto step = blockSteps.find(rocket);
+        if (step != blockSteps.end() && step->second.ticksLeft > 0) continue;
+
+        RocketRails entry;
+        if (fitRails(rocket, entry)) {
+            next[rocket] = entry;
+        }
     }
 
-    // Apply gravity to the vehicle manager's active vehicle
-    if (vehicleManager) {
-        if (vehicleManager->getActiveVehicleType() == VehicleType::ROCKET) {
-            Rocket* rocket = vehicleManager->getRocket();
-            if (rocket) {
-                for (auto planet : planets) {
-                    sf::Vector2f direction = planet->getPosition() - rocket->getPosition();
-                    float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                    // Avoid division by zero and very small distances
-                    if (distance > planet->getRadius() + GameConstants::TRAJECTORY_COLLISION_RADIUS) {
-                        float forceMagnitude = G * planet->getMass() * rocket->getMass() / (distance * distance);
-                        sf::Vector2f acceleration = normalize(direction) * forceMagnitude / rocket->getMass();
-                        sf::Vector2f velocityChange = acceleration * deltaTime;
-                        rocket->setVelocity(rocket->getVelocity() + velocityChange);
-                    }
-                }
+    rails.swap(next);
+}
+
+void GravitySimulator::update(float deltaTime)
+{
+    // Copy the current object state into the packed arrays
+    gatherBodies();
+
+    steppedBodies.resize(bodies.size() - rocketBegin);
+    for (size_t r = 0; r < steppedBodies.size(); r++) {
+        steppedBodies[r] = rocketBegin + r;
+    }
+    accelX.assign(bodies.size(), 0.0);
+    accelY.assign(bodies.size(), 0.0);
+    forceEvaluations = 0;
+    stageTime = simulationTime;
+
+    // Block timesteps are a leapfrog hierarchy; the other schemes step every body together
+    if (adaptiveTimesteps && Integrator::getActiveType() == IntegratorType::LEAPFROG) {
+        updateBlockTimesteps(deltaTime);
+    }
+    else {
+        // Steps still open from the block hierarchy close first, so no velocity stays half-kicked
+        closeBlockSteps(deltaTime);
+
+        // Advance positions and velocities together with the active integrator
+        Integrator::step(deltaTime,
+            [this](float dt) { kick(dt); },
+            [this](float dt) { drift(dt); });
+    }
+
+    updateParticles(simulationTime, deltaTime);
+
+    // Land the planets exactly on the table, whatever rounding the stage times picked up
+    simulationTime += deltaTime;
+    placePlanets(simulationTime);
+
+    scatterState();
+    updateRails();
+
+    // The kinematic planets' share is integrated every tick, the rest only measured at samples
+    if (diagnostics.isEnabled()) {
+        gatherDiagnosticBodies();
+        diagnostics.accumulate(diagnosticBodies, G, deltaTime, simulatePlanetGravity, rocketGravity);
+        if (diagnostics.tick()) {
+            sampleDiagnostics();
+        }
+    }
+}
+
+void GravitySimulator::gatherDiagnosticBodies()
+{
+    // Every planet, and every rocket in play including those on rails, which the packed store
+    // leaves out. Parked rockets ride along with their planet and aren't simulated at all.
+    diagnosticBodies.clear();
+    for (auto planet : planets) {
+        const Vector2d& pos = planet->getWorldPosition();
+        const Vector2d& vel = planet->getWorldVelocity();
+
+        std::uint32_t flags = BodyFlags::PLANET;
+        if (planet->getMotionSource() == MotionSource::PINNED) {
+            flags |= BodyFlags::PINNED;
+        }
+        else if (planet->getMotionSource() == MotionSource::PRESCRIBED) {
+            flags |= BodyFlags::PRESCRIBED;
+        }
+        diagnosticBodies.add(pos.x, pos.y, vel.x, vel.y, planet->getMass(), planet->getRadius(), flags);
+    }
+
+    diagnosticRockets.clear();
+    if (!vehicleManagers.empty()) {
+        for (auto manager : vehicleManagers) {
+            if (manager->getActiveVehicleType() == VehicleType::ROCKET && manager->getRocket()) {
+                diagnosticRockets.push_back(manager->getRocket());
             }
         }
-        // Car gravity is handled internally in Car::update
     }
     else {
-        // Legacy code for handling individual rockets
-        for (auto rocket : rockets) {
-            for (auto planet : planets) {
-                sf::Vector2f direction = planet->getPosition() - rocket->getPosition();
-                float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                // Avoid division by zero and very small distances
-                if (distance > planet->getRadius() + GameConstants::TRAJECTORY_COLLISION_RADIUS) {
-                    float forceMagnitude = G * planet->getMass() * rocket->getMass() / (distance * distance);
-                    sf::Vector2f acceleration = normalize(direction) * forceMagnitude / rocket->getMass();
-                    sf::Vector2f velocityChange = acceleration * deltaTime;
-                    rocket->setVelocity(rocket->getVelocity() + velocityChange);
-                }
+        diagnosticRockets.assign(rockets.begin(), rockets.end());
+    }
+    for (const Rocket* rocket : diagnosticRockets) {
+        if (rocket->isSleeping()) continue;
+        const Vector2d& pos = rocket->getWorldPosition();
+        const Vector2d& vel = rocket->getWorldVelocity();
+        diagnosticBodies.add(pos.x, pos.y, vel.x, vel.y, rocket->getMass(), 0.0, BodyFlags::ROCKET);
+    }
+}
+
+void GravitySimulator::sampleDiagnostics()
+{
+    // Thrust and surface contact bump a rocket's trajectory revision
+    unsigned long long revisions = 0;
+    for (const Rocket* rocket : diagnosticRockets) {
+        revisions += rocket->getTrajectoryRevision();
+    }
+    bool disturbed = revisions != diagnosticRevisions;
+    diagnosticRevisions = revisions;
+
+    // Rockets attract each other as in computeAccelerations
+    diagnostics.record(diagnosticBodies, G, simulationTime, simulatePlanetGravity, rocketGravity, disturbed);
+}
+
+PlanetEphemeris& GravitySimulator::getEphemeris()
+{
+    ephemeris.sync(planets, simulationTime, simulatePlanetGravity, solver, openingAngle);
+    return ephemeris;
+}
+
+GravitySources GravitySimulator::packPlanetsAt(PlanetEphemeris& table, double time, BodyStore& store)
+{
+    store.clear();
+    for (size_t j = 0; j < table.getPlanetCount(); j++) {
+        Vector2d position = table.positionAt(j, time);
+        store.add(position.x, position.y, 0.0, 0.0, table.getMass(j), table.getRadius(j), BodyFlags::PLANET);
+    }
+    return { store.x.data(), store.y.data(), store.mass.data(), store.radius.data(), store.size() };
+}
+
+void GravitySimulator::updateParticles(double startTime, float deltaTime)
+{
+    if (particles.empty()) return;
+
+    // Same integrator as the bodies, replayed against the table at the particles' own stage
+    // times. Particles are massless, so nothing else needs them until the step is done.
+    double time = startTime;
+    particles.beginStep();
+    Integrator::step(deltaTime,
+        [this, &time](float dt) { particles.kick(packPlanetsAt(ephemeris, time, particleSources), G, dt, *jobs); },
+        [this, &time](float dt) { particles.drift(dt); time += dt; });
+    particles.endStep(deltaTime);
+}
+
+bool GravitySimulator::accelerationsAt(const Vector2d* points, size_t count, double time,
+    Vector2d* accelerations, Vector2d* contributions)
+{
+    queryPoints += count;
+    return accelerationsAt(getEphemeris(), querySources, points, count, time, accelerations, contributions);
+}
+
+bool GravitySimulator::accelerationsAt(PlanetEphemeris& table, BodyStore& scratch, const Vector2d* points, size_t count,
+    double time, Vector2d* accelerations, Vector2d* contributions)
+{
+    // Planets where they are at the requested time
+    packPlanetsAt(table, time, scratch);
+    const size_t planetCount = scratch.size();
+    const double exclusion = GameConstants::TRAJECTORY_COLLISION_RADIUS;
+    const double G = GameConstants::G;
+
+    bool skipped = false;
+    for (size_t p = 0; p < count; p++) {
+        double ax = 0.0;
+        double ay = 0.0;
+        if (!contributions) {
+            GravitySources sources = { scratch.x.data(), scratch.y.data(), scratch.mass.data(),
+                scratch.radius.data(), planetCount };
+            skipped |= GravityKernel::accumulate(sources, points[p].x, points[p].y, G, exclusion, 0.0, ax, ay);
+        }
+        else {
+            // One planet at a time through the same kernel, so the shares add up to the total exactly
+            Vector2d* shares = contributions + p * planetCount;
+            for (size_t j = 0; j < planetCount; j++) {
+                GravitySources source = { &scratch.x[j], &scratch.y[j], &scratch.mass[j],
+                    &scratch.radius[j], 1 };
+                double shareX = 0.0;
+                double shareY = 0.0;
+                skipped |= GravityKernel::accumulate(source, points[p].x, points[p].y, G, exclusion, 0.0, shareX, shareY);
+                shares[j] = Vector2d(shareX, shareY);
+                ax += shareX;
+                ay += shareY;
             }
         }
+        accelerations[p] = Vector2d(ax, ay);
+    }
+    return skipped;
+}
+
+float GravitySimulator::measureBarnesHutError()
+{
+    // Accumulate squared errors and squared magnitudes - a per-body ratio would be dominated
+    // by bodies whose pulls nearly cancel
+    double errorSquared = 0.0;
+    double magnitudeSquared = 0.0;
+    if (simulatePlanetGravity) {
+        getEphemeris().measureTreeError(simulationTime, openingAngle, errorSquared, magnitudeSquared);
+    }
+
+    // The rocket pass as each solver runs it, on the packed bodies the last step left behind
+    std::vector<size_t> targets;
+    for (size_t i = rocketBegin; i < bodies.size(); i++) {
+        targets.push_back(i);
+    }
+    if (!targets.empty()) {
+        const GravitySolver selected = solver;
+        accelX.assign(bodies.size(), 0.0);
+        accelY.assign(bodies.size(), 0.0);
+        solver = GravitySolver::PAIRWISE;
+        accumulatePlanetGravityOnRockets(targets.data(), targets.size());
+        std::vector<double> exactX = accelX;
+        std::vector<double> exactY = accelY;
+
+        accelX.assign(bodies.size(), 0.0);
+        accelY.assign(bodies.size(), 0.0);
+        solver = GravitySolver::BARNES_HUT;
+        buildPlanetTree();
+        accumulatePlanetGravityOnRockets(targets.data(), targets.size());
+        solver = selected;
+
+        for (size_t i : targets) {
+            double dx = accelX[i] - exactX[i];
+            double dy = accelY[i] - exactY[i];
+            errorSquared += dx * dx + dy * dy;
+            magnitudeSquared += exactX[i] * exactX[i] + exactY[i] * exactY[i];
+        }
+    }
 
-        // Add rocket-to-rocket gravity interactions
-        addRocketGravityInteractions(deltaTime);
+    if (magnitudeSquared <= 0.0) {
+        return 0.0f;
     }
+    return static_cast<float>(std::sqrt(errorSquared / magnitudeSquared));
 }
\ No newline at end of file
@@ -4,6 +4,17 @@
 #include "Rocket.h"
 #include "VectorHelper.h"
 #include "GameConstants.h"  // Include the constants
+#include "BarnesHutTree.h"
+#include "BodyStore.h"
+#include "ConservationMonitor.h"
+#include "GravityKernel.h"
+#include "Integrator.h"
+#include "JobSystem.h"
+#include "KeplerOrbit.h"
+#include "ParticlePool.h"
+#include "PlanetEphemeris.h"
+#include "SpatialHashGrid.h"
+#include <unordered_map>
 #include <vector>
 
 // Forward declaration
@@ -13,20 +24,217 @@ class GravitySimulator {
 private:
     std::vector<Planet*> planets;
     std::vector<Rocket*> rockets;
-    VehicleManager* vehicleManager = nullptr;
+    std::vector<VehicleManager*> vehicleManagers;  // Every player whose active rocket feels planet gravity
     const float G = GameConstants::G;  // Use the constant from the header
     bool simulatePlanetGravity = true;
+    GravitySolver solver = GravitySolver::PAIRWISE;
+    float openingAngle = GameConstants::BARNES_HUT_OPENING_ANGLE;
+    BarnesHutTree planetTree;
+    BarnesHutTree rocketTree;
+
+    // Rocket-rocket gravity. The pairwise solver only sums rockets within the cutoff, which
+    // the grid finds; Barnes-Hut sums every rocket through the tree. The same grid also
+    // tells which rockets are too close to others to coast on rails.
+    bool rocketGravity = true;
+    double rocketGravityCutoff = GameConstants::ROCKET_GRAVITY_CUTOFF;
+    SpatialHashGrid rocketGrid;
+    std::vector<Rocket*> candidateRockets;  // Rockets that could take part in a step, for the proximity test
+    std::vector<double> candidateX;
+    std::vector<double> candidateY;
+
+    // Force and integration passes are split into chunks of bodies on this pool
+    JobSystem* jobs = &JobSystem::getShared();
+
+    // Packed copy of the simulated bodies: planets first, then the rockets in storedRockets.
+    // All active rockets sit in one contiguous range so planet gravity is a single sweep.
+    // Planets are placed from the ephemeris at each stage; only the rockets are integrated.
+    BodyStore bodies;
+    std::vector<Rocket*> storedRockets;
+    size_t rocketBegin = 0;
+
+    // Accelerations of the packed bodies at their current positions
+    std::vector<double> accelX;
+    std::vector<double> accelY;
+    std::vector<size_t> steppedBodies;  // rocketBegin..n-1, the bodies the integrator advances
+
+    // Planet states for every stage of a step come from one shared table
+    PlanetEphemeris ephemeris;
+    double simulationTime = 0.0;
+    double stageTime = 0.0;             // Time reached by the drifts of the current step
+
+    // Planets packed at the time of the last accelerationsAt query
+    BodyStore querySources;
+    size_t queryPoints = 0;
+
+    // Massless particles, pulled by the planets at the same stage times as the rockets
+    ParticlePool particles;
+    BodyStore particleSources;
+
+    // Energy and momentum telemetry, sampled from the live objects every few ticks
+    ConservationMonitor diagnostics;
+    BodyStore diagnosticBodies;
+    std::vector<const Rocket*> diagnosticRockets;
+    unsigned long long diagnosticRevisions = 0;    // Sum of rocket trajectory revisions at the last sample
+    void gatherDiagnosticBodies();
+    void sampleDiagnostics();
+
+    // Block timesteps: body i advances with deltaTime / 2^timestepLevels[i], or over
+    // stepTicks[i] whole simulation steps when its acceleration changes slowly enough
+    bool adaptiveTimesteps = true;
+    std::vector<int> timestepLevels;
+    std::vector<int> stepTicks;         // Simulation steps in the body's current step; 1 for steps within one
+    std::vector<int> stepTicksLeft;     // Of those, the ones still to go, counting this one
+    size_t forceEvaluations = 0;        // Per-body force evaluations in the last update
+
+    // What a rocket's block step leaves for the next update: the acceleration of its last
+    // closing kick, which the next opening kick reuses, or of its opening kick while a step of
+    // several ticks is under way. The integrator's velocity is half-kicked until that step
+    // closes, so it is kept here and the rocket is given its velocity at the current time.
+    struct BlockStep {
+        Vector2d acceleration;
+        Vector2d lastPosition;      // Position written by the last step; any change means contact or a teleport
+        Vector2d lastVelocity;      // Velocity written by the last step; any change means thrust or contact
+        Vector2d halfKickedVelocity;    // The integrator's velocity while the step is open
+        int ticks = 1;
+        int ticksLeft = 0;          // 0 once the step has closed
+    };
+    std::unordered_map<const Rocket*, BlockStep> blockSteps;
+    long long blockTick = 0;            // Updates run with block timesteps, for aligning long steps
+    unsigned long long blockRevision = 0;   // Planet table the carried accelerations came from
+
+    // Patched conics: a coasting rocket follows an analytic conic around the planet whose
+    // sphere of influence it is in, instead of being integrated against every planet
+    struct RocketRails {
+        KeplerOrbit orbit;
+        int centralBody = -1;       // Planet index
+        Vector2d lastPosition;      // State written by the last step; any change means thrust or contact
+        Vector2d lastVelocity;
+    };
+    bool patchedConics = true;
+    std::unordered_map<const Rocket*, RocketRails> rails;
+    std::vector<Rocket*> railRockets;   // Rockets moved analytically this step
+    std::vector<double> soiRadius;      // Per planet, 0 for the root
+    int rootBody = -1;
+
+    // Rails ignore rocket-rocket gravity, so only a rocket with no other rocket within the
+    // cutoff (or no other rocket at all, without one) may take them
+    bool usesRails() const { return patchedConics && !vehicleManagers.empty(); }
+    bool usesRocketGrid() const { return solver == GravitySolver::PAIRWISE && rocketGravityCutoff > 0.0; }
+    bool hasRocketNearby(size_t candidate) const;
+    void findSpheresOfInfluence();
+    int findDominantBody(const Vector2d& point) const;
+    bool fitRails(const Rocket* rocket, RocketRails& entry) const;
+    void updateRails();
+
+    void gatherBodies();
+    void scatterState();
+    void placePlanets(double time);
+    GravitySources getPlanetSources() const;
+    // Every planet at a time from a planet table, packed into store
+    static GravitySources packPlanetsAt(PlanetEphemeris& table, double time, BodyStore& store);
+    void updateParticles(double startTime, float deltaTime);
+    void buildPlanetTree();
+
+    // Each pass adds onto the accelerations of the listed rockets (ascending indices). The
+    // planets pull on each other inside the ephemeris, with the same solver and job system.
+    void accumulatePlanetGravityOnRockets(const size_t* targets, size_t count);
+    // Rocket-to-rocket gravity over the rockets gathered for the current step. The tree or
+    // grid is built once by buildRocketGravity, so chunks of targets can run concurrently.
+    void buildRocketGravity();
+    void accumulateRocketGravity(const size_t* targets, size_t count);
+    void accumulateRocketGravityWithCutoff(const size_t* targets, size_t count);
+    // Recompute accelerations for the listed rockets only
+    void computeAccelerations(const std::vector<size_t>& targets);
+
+    // Integrator stages over the packed bodies
+    void kick(float deltaTime);
+    void drift(float deltaTime);
+
+    // |a| / |da/dt| for a rocket, or a negative value if its acceleration doesn't change
+    double getJerkTimescale(size_t i) const;
+    // Pick every body's level from its jerk timescale; returns the finest level in use
+    int assignTimestepLevels(float deltaTime);
+    // Pick up the accelerations and long steps carried over from the last update
+    void resumeBlockSteps(float deltaTime);
+    // Give a rocket part-way through a long step the integrator's velocity back, keeping any
+    // change made to the written one since
+    void restoreHalfKick(size_t i, const BlockStep& step);
+    // Close a step of several ticks before its time, as a shorter kick-drift-kick step
+    void endBlockStepEarly(size_t i, const Vector2d& opening, int ticks, int ticksLeft, float deltaTime);
+    // Close every open long step, for updates that leave the block hierarchy
+    void closeBlockSteps(float deltaTime);
+    // Hierarchical kick-drift-kick where only bodies due at a substep get new forces
+    void updateBlockTimesteps(float deltaTime);
 
 public:
     void addPlanet(Planet* planet);
     void addRocket(Rocket* rocket);
-    void addVehicleManager(VehicleManager* manager) { vehicleManager = manager; }
+    void addVehicleManager(VehicleManager* manager);
+    void removeVehicleManager(VehicleManager* manager);
+    const std::vector<VehicleManager*>& getVehicleManagers() const { return vehicleManagers; }
+    // Advance every planet and gathered rocket by one step of the active integrator
     void update(float deltaTime);
     void clearRockets();
-    void addRocketGravityInteractions(float deltaTime);
 
     const std::vector<Planet*>& getPlanets() const { return planets; }
+    const BodyStore& getBodies() const { return bodies; }
+    double getSimulationTime() const { return simulationTime; }
+    // Planet table synced to the planets' current state, for predictions and orbit paths
+    PlanetEphemeris& getEphemeris();
+
+    // Planet gravity at a batch of points at a simulation time - the one query behind
+    // trajectory previews, force vectors and the HUD. Writes each point's acceleration and,
+    // if contributions isn't null, every planet's share of it (count * planet count entries,
+    // one row per point). Planets closer than their radius plus TRAJECTORY_COLLISION_RADIUS
+    // are left out; returns true if that happened for any point.
+    bool accelerationsAt(const Vector2d* points, size_t count, double time,
+        Vector2d* accelerations, Vector2d* contributions = nullptr);
+    size_t getQueryPointCount() const { return queryPoints; }   // Points evaluated by accelerationsAt so far
+
+    // The same query against any planet table, with the caller's scratch for the packed
+    // planets - for work that runs on its own copy of the table, such as the background predictor
+    static bool accelerationsAt(PlanetEphemeris& table, BodyStore& scratch, const Vector2d* points, size_t count,
+        double time, Vector2d* accelerations, Vector2d* contributions = nullptr);
+
+    // Massless test particles stepped alongside the rockets
+    ParticlePool& getParticles() { return particles; }
     void setSimulatePlanetGravity(bool enable) { simulatePlanetGravity = enable; }
+    bool getSimulatePlanetGravity() const { return simulatePlanetGravity; }
+
+    // Per-body block timesteps, used while the active integrator is leapfrog
+    void setAdaptiveTimesteps(bool enable) { adaptiveTimesteps = enable; }
+    bool getAdaptiveTimesteps() const { return adaptiveTimesteps; }
+    size_t getLastForceEvaluationCount() const { return forceEvaluations; }
+
+    // Patched-conic propagation for coasting rockets
+    void setPatchedConics(bool enable) { patchedConics = enable; }
+    bool getPatchedConics() const { return patchedConics; }
+    size_t getRailRocketCount() const { return railRockets.size(); }
+
+    // Conservation diagnostics: off by default, since the exact potential is O(n^2)
+    void setDiagnosticsEnabled(bool enable) { diagnostics.setEnabled(enable); }
+    bool getDiagnosticsEnabled() const { return diagnostics.isEnabled(); }
+    ConservationMonitor& getDiagnostics() { return diagnostics; }
+
+    // Pool the force and integration passes run on; results don't depend on its size
+    void setJobSystem(JobSystem* system) { jobs = system; ephemeris.setJobSystem(system); }
+    JobSystem& getJobSystem() { return *jobs; }
+
+    // Gravity solver selection
+    void setGravitySolver(GravitySolver newSolver) { solver = newSolver; }
+    GravitySolver getGravitySolver() const { return solver; }
+    void setOpeningAngle(float theta) { openingAngle = theta; }
+    float getOpeningAngle() const { return openingAngle; }
+    // Rockets attracting each other, for every player as well as the legacy rockets
+    void setRocketGravity(bool enable) { rocketGravity = enable; }
+    bool getRocketGravity() const { return rocketGravity; }
+    // Distance beyond which rockets stop attracting each other under the pairwise solver;
+    // 0 sums every pair. Barnes-Hut always covers every rocket.
+    void setRocketGravityCutoff(double cutoff) { rocketGravityCutoff = cutoff; }
+    double getRocketGravityCutoff() const { return rocketGravityCutoff; }
 
-    void removeVehicleManager(VehicleManager* manager) {if (vehicleManager == manager) {vehicleManager = nullptr; }}
+    // RMS error of Barnes-Hut relative to the exact pairwise sum, over the forces the tree is
+    // used for: the planets' pull on each other in the ephemeris, at the current time, and
+    // their pull on the rockets of the last step. BarnesHutCheck runs this on random scenes.
+    float measureBarnesHutError();
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+// Integrator.cpp
+#include "Integrator.h"
+#include <atomic>
+
+namespace {
+    // Yoshida's weights: w1 = 1 / (2 - 2^(1/3)), w0 = -2^(1/3) / (2 - 2^(1/3))
+    constexpr float YOSHIDA_W1 = 1.3512071919596578f;
+    constexpr float YOSHIDA_W0 = -1.7024143839193155f;
+
+    const IntegratorStage EULER_STAGES[] = {
+        { IntegratorOp::KICK, 1.0f },
+        { IntegratorOp::DRIFT, 1.0f }
+    };
+
+    const IntegratorStage LEAPFROG_STAGES[] = {
+        { IntegratorOp::KICK, 0.5f },
+        { IntegratorOp::DRIFT, 1.0f },
+        { IntegratorOp::KICK, 0.5f }
+    };
+
+    // Leapfrog steps of w1, w0, w1 with the touching half kicks merged
+    const IntegratorStage YOSHIDA4_STAGES[] = {
+        { IntegratorOp::KICK, YOSHIDA_W1 * 0.5f },
+        { IntegratorOp::DRIFT, YOSHIDA_W1 },
+        { IntegratorOp::KICK, (YOSHIDA_W1 + YOSHIDA_W0) * 0.5f },
+        { IntegratorOp::DRIFT, YOSHIDA_W0 },
+        { IntegratorOp::KICK, (YOSHIDA_W0 + YOSHIDA_W1) * 0.5f },
+        { IntegratorOp::DRIFT, YOSHIDA_W1 },
+        { IntegratorOp::KICK, YOSHIDA_W1 * 0.5f }
+    };
+
+    // Set from input on the main thread and read by the trajectory predictor's worker
+    std::atomic<IntegratorType> activeType{ IntegratorType::LEAPFROG };
+}
+
+const IntegratorStage* Integrator::getStages(IntegratorType type, int& count)
+{
+    switch (type) {
+    case IntegratorType::SEMI_IMPLICIT_EULER:
+        count = sizeof(EULER_STAGES) / sizeof(EULER_STAGES[0]);
+        return EULER_STAGES;
+    case IntegratorType::YOSHIDA4:
+        count = sizeof(YOSHIDA4_STAGES) / sizeof(YOSHIDA4_STAGES[0]);
+        return YOSHIDA4_STAGES;
+    case IntegratorType::LEAPFROG:
+    default:
+        count = sizeof(LEAPFROG_STAGES) / sizeof(LEAPFROG_STAGES[0]);
+        return LEAPFROG_STAGES;
+    }
+}
+
+const char* Integrator::getName(IntegratorType type)
+{
+    switch (type) {
+    case IntegratorType::SEMI_IMPLICIT_EULER: return "Semi-implicit Euler";
+    case IntegratorType::YOSHIDA4: return "Yoshida 4";
+    case IntegratorType::LEAPFROG:
+    default: return "Leapfrog";
+    }
+}
+
+IntegratorType Integrator::getActiveType()
+{
+    return activeType.load(std::memory_order_relaxed);
+}
+
+void Integrator::setActiveType(IntegratorType type)
+{
+    activeType.store(type, std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Integrator.h
+#pragma once
+
+// Time integration schemes, written as a sequence of velocity kicks and position drifts
+enum class IntegratorType {
+    SEMI_IMPLICIT_EULER,  // Kick then drift, first order
+    LEAPFROG,             // Kick-drift-kick, second order
+    YOSHIDA4              // Three leapfrog steps with Yoshida weights, fourth order
+};
+
+enum class IntegratorOp {
+    KICK,   // v += a(x) * coefficient * dt
+    DRIFT   // x += v * coefficient * dt
+};
+
+struct IntegratorStage {
+    IntegratorOp op;
+    float coefficient;
+};
+
+namespace Integrator {
+    // Stages of one step of the given scheme
+    const IntegratorStage* getStages(IntegratorType type, int& count);
+
+    // Run one step of the active scheme. kick(dt) must evaluate accelerations at the
+    // current positions before changing velocities; drift(dt) moves the positions.
+    template <typename KickFunction, typename DriftFunction>
+    void step(float deltaTime, KickFunction kick, DriftFunction drift);
+
+    // Same as step() with a fixed scheme, for work that must not follow the active one
+    template <typename KickFunction, typename DriftFunction>
+    void stepWith(IntegratorType type, float deltaTime, KickFunction kick, DriftFunction drift);
+
+    const char* getName(IntegratorType type);
+
+    // Scheme used by the live simulation and by every trajectory prediction, so
+    // predicted paths match what the simulation will actually do
+    IntegratorType getActiveType();
+    void setActiveType(IntegratorType type);
+}
+
+template <typename KickFunction, typename DriftFunction>
+void Integrator::step(float deltaTime, KickFunction kick, DriftFunction drift)
+{
+    stepWith(getActiveType(), deltaTime, kick, drift);
+}
+
+template <typename KickFunction, typename DriftFunction>
+void Integrator::stepWith(IntegratorType type, float deltaTime, KickFunction kick, DriftFunction drift)
+{
+    int count = 0;
+    const IntegratorStage* stages = getStages(type, count);
+    for (int i = 0; i < count; i++) {
+        if (stages[i].op == IntegratorOp::KICK) {
+            kick(stages[i].coefficient * deltaTime);
+        }
+        else {
+            drift(stages[i].coefficient * deltaTime);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+// JobSystem.cpp
+#include "JobSystem.h"
+#include "GameConstants.h"
+#include <algorithm>
+
+JobSystem::JobSystem(int threads)
+{
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    const size_t workerCount = static_cast<size_t>(threads - 1);
+    for (size_t i = 0; i < workerCount; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t JobSystem::getChunkCount(size_t count, size_t grain)
+{
+    grain = std::max<size_t>(grain, 1);
+    return (count + grain - 1) / grain;
+}
+
+bool JobSystem::popOrSteal(size_t home, Chunk& chunk)
+{
+    const size_t queueCount = queues.size();
+    if (home < queueCount) {
+        Queue& own = *queues[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.back();
+            own.chunks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (size_t k = 1; k <= queueCount; k++) {
+        Queue& victim = *queues[(home + k) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::workerLoop(size_t index)
+{
+    while (true) {
+        Chunk chunk;
+        if (popOrSteal(index, chunk)) {
+            (*chunk.job)(chunk.begin, chunk.end);
+            chunk.pending->fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+void JobSystem::run(size_t count, size_t grain, const Job& job)
+{
+    const size_t chunkCount = getChunkCount(count, grain);
+    std::atomic<size_t> pending{ chunkCount };
+
+    // Deal the chunks out in contiguous runs, so a worker's own chunks are neighbours in memory
+    const size_t queueCount = queues.size();
+    const size_t perQueue = (chunkCount + queueCount - 1) / queueCount;
+    for (size_t q = 0; q < queueCount; q++) {
+        const size_t first = q * perQueue;
+        const size_t last = std::min(chunkCount, first + perQueue);
+        if (first >= last) break;
+
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        for (size_t c = first; c < last; c++) {
+            queues[q]->chunks.push_back({ &job, c * grain, std::min(count, (c + 1) * grain), &pending });
+        }
+        queued.fetch_add(last - first);
+    }
+    {
+        // Taking the lock orders the push before any worker's wait check
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_all();
+
+    // Help until this loop is finished; stolen chunks may belong to other loops, which is fine
+    while (pending.load(std::memory_order_acquire) > 0) {
+        Chunk chunk;
+        if (popOrSteal(queueCount, chunk)) {
+            (*chunk.job)(chunk.begin, chunk.end);
+            chunk.pending->fetch_sub(1, std::memory_order_release);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+JobSystem& JobSystem::getShared()
+{
+    static JobSystem shared(GameConstants::JOB_THREADS);
+    return shared;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+// JobSystem.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for data-parallel loops. Each worker owns a queue of chunks and
+// takes from its back; an idle worker, or a thread waiting on its own loop, steals from the
+// front of the others'. Chunk boundaries depend only on the loop size and grain, never on
+// the thread count, so a loop whose chunks write disjoint results - or whose per-chunk
+// results are combined in chunk order afterwards - gives bit-identical output on any pool.
+class JobSystem {
+private:
+    using Job = std::function<void(size_t begin, size_t end)>;
+
+    struct Chunk {
+        const Job* job;
+        size_t begin;
+        size_t end;
+        std::atomic<size_t>* pending;   // Chunks of the owning loop still running
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;     // One per worker
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<size_t> queued{ 0 };
+    bool stopping = false;
+
+    // Own queue first (from the back), then the others (from the front)
+    bool popOrSteal(size_t home, Chunk& chunk);
+    void workerLoop(size_t index);
+    void run(size_t count, size_t grain, const Job& job);
+
+public:
+    // threads counts the calling thread too; 0 picks one per hardware thread
+    explicit JobSystem(int threads = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Call job(begin, end) over [0, count) in chunks of grain items and return once every
+    // chunk is done. The caller works on chunks too, so loops may nest.
+    template <typename Function>
+    void parallelFor(size_t count, size_t grain, Function job);
+
+    // Chunks parallelFor will split a loop into, for callers that keep per-chunk results
+    static size_t getChunkCount(size_t count, size_t grain);
+
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Pool shared by the simulation, sized by GameConstants::JOB_THREADS
+    static JobSystem& getShared();
+};
+
+template <typename Function>
+void JobSystem::parallelFor(size_t count, size_t grain, Function job)
+{
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    // A single chunk isn't worth a trip through the queues
+    if (count <= grain || workers.empty()) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            job(begin, std::min(count, begin + grain));
+        }
+        return;
+    }
+    run(count, grain, Job(job));
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+// KeplerOrbit.cpp
+#include "KeplerOrbit.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr int MAX_KEPLER_ITERATIONS = 50;
+    constexpr double KEPLER_TOLERANCE = 1e-12;
+    // Eccentricities this close to 0 or 1 are treated as a circle or a parabola
+    constexpr double CONIC_EPSILON = 1e-9;
+
+    // Stumpff functions C(z) and S(z), with series near zero where the closed forms cancel
+    double stumpffC(double z)
+    {
+        if (z > 1e-6) {
+            return (1.0 - std::cos(std::sqrt(z))) / z;
+        }
+        if (z < -1e-6) {
+            return (std::cosh(std::sqrt(-z)) - 1.0) / -z;
+        }
+        return 0.5 - z / 24.0 + z * z / 720.0;
+    }
+
+    double stumpffS(double z)
+    {
+        if (z > 1e-6) {
+            double s = std::sqrt(z);
+            return (s - std::sin(s)) / (s * s * s);
+        }
+        if (z < -1e-6) {
+            double s = std::sqrt(-z);
+            return (std::sinh(s) - s) / (s * s * s);
+        }
+        return 1.0 / 6.0 - z / 120.0 + z * z / 5040.0;
+    }
+}
+
+KeplerOrbit::KeplerOrbit(const Vector2d& relativePosition, const Vector2d& relativeVelocity, double gravitationalParameter, double time)
+    : mu(gravitationalParameter), epochPosition(relativePosition), epochVelocity(relativeVelocity), epochTime(time)
+{
+    double r = std::sqrt(relativePosition.x * relativePosition.x + relativePosition.y * relativePosition.y);
+    double vSquared = relativeVelocity.x * relativeVelocity.x + relativeVelocity.y * relativeVelocity.y;
+    alpha = 2.0 / r - vSquared / mu;
+    period = (alpha > 0.0) ? 2.0 * PI / std::sqrt(mu * alpha * alpha * alpha) : 0.0;
+
+    // e = ((v^2 - mu / r) r - (r . v) v) / mu
+    double rDotV = relativePosition.x * relativeVelocity.x + relativePosition.y * relativeVelocity.y;
+    Vector2d eccentricityVector = (relativePosition * (vSquared - mu / r) - relativeVelocity * rDotV) / mu;
+    eccentricity = std::sqrt(eccentricityVector.x * eccentricityVector.x + eccentricityVector.y * eccentricityVector.y);
+    periapsisDirection = eccentricity > CONIC_EPSILON ? eccentricityVector / eccentricity : relativePosition / r;
+
+    double angularMomentum = relativePosition.x * relativeVelocity.y - relativePosition.y * relativeVelocity.x;
+    semiLatusRectum = angularMomentum * angularMomentum / mu;
+    turn = angularMomentum < 0.0 ? -1.0 : 1.0;
+}
+
+void KeplerOrbit::stateAt(double time, Vector2d& relativePosition, Vector2d& relativeVelocity) const
+{
+    double dt = time - epochTime;
+    if (period > 0.0) {
+        // Whole revolutions change nothing and would only slow down the solver
+        dt = std::fmod(dt, period);
+        if (dt < 0.0) {
+            dt += period;
+        }
+    }
+
+    const double sqrtMu = std::sqrt(mu);
+    const double r0 = std::sqrt(epochPosition.x * epochPosition.x + epochPosition.y * epochPosition.y);
+    const double radialVelocity = (epochPosition.x * epochVelocity.x + epochPosition.y * epochVelocity.y) / r0;
+
+    // Universal Kepler equation residual; its derivative in chi is the radius, so it only increases
+    auto kepler = [&](double x, double& derivative) {
+        double z = alpha * x * x;
+        double c = stumpffC(z);
+        double s = stumpffS(z);
+        derivative = r0 * radialVelocity / sqrtMu * x * (1.0 - z * s) + (1.0 - alpha * r0) * x * x * c + r0;
+        return r0 * radialVelocity / sqrtMu * x * x * c + (1.0 - alpha * r0) * x * x * x * s + r0 * x - sqrtMu * dt;
+    };
+
+    double chi = sqrtMu * std::abs(alpha) * dt;
+    if (alpha <= 0.0 || chi == 0.0) {
+        chi = sqrtMu * dt / r0;
+    }
+
+    // Bracket the root: one revolution spans 2 pi / sqrt(alpha) for an ellipse; otherwise widen
+    // the guess until the residual changes sign
+    double derivative = 0.0;
+    double low = std::min(0.0, chi);
+    double high = std::max(0.0, chi);
+    if (period > 0.0) {
+        low = 0.0;
+        high = 2.0 * PI / std::sqrt(alpha);
+    }
+    else {
+        double step = std::max(std::abs(chi), 1e-6);
+        while (kepler(low, derivative) > 0.0) low -= (step *= 2.0);
+        while (kepler(high, derivative) < 0.0) high += (step *= 2.0);
+    }
+    chi = std::max(low, std::min(high, chi));
+
+    // Newton's method, falling back to bisection whenever a step leaves the bracket - near
+    // periapsis of an almost radial orbit the radius, and so the derivative, nearly vanishes
+    for (int i = 0; i < MAX_KEPLER_ITERATIONS; i++) {
+        double f = kepler(chi, derivative);
+        if (f < 0.0) {
+            low = chi;
+        }
+        else {
+            high = chi;
+        }
+
+        double next = chi - f / derivative;
+        if (!(next > low && next < high)) {
+            next = 0.5 * (low + high);
+        }
+        double correction = chi - next;
+        chi = next;
+        if (std::abs(correction) <= KEPLER_TOLERANCE * std::max(1.0, std::abs(chi))) break;
+    }
+
+    // Lagrange coefficients
+    double z = alpha * chi * chi;
+    double c = stumpffC(z);
+    double s = stumpffS(z);
+    double f = 1.0 - chi * chi / r0 * c;
+    double g = dt - chi * chi * chi / sqrtMu * s;
+    relativePosition = epochPosition * f + epochVelocity * g;
+
+    double r = std::sqrt(relativePosition.x * relativePosition.x + relativePosition.y * relativePosition.y);
+    double fDot = sqrtMu / (r * r0) * (z * s - 1.0) * chi;
+    double gDot = 1.0 - chi * chi / r * c;
+    relativeVelocity = epochPosition * fDot + epochVelocity * gDot;
+}
+
+double KeplerOrbit::getSemiMajorAxis() const
+{
+    return 1.0 / alpha;
+}
+
+double KeplerOrbit::getEccentricity() const
+{
+    return eccentricity;
+}
+
+double KeplerOrbit::getPeriapsis() const
+{
+    // a (1 - e) holds for ellipses and hyperbolas (where a < 0 and e > 1)
+    return getSemiMajorAxis() * (1.0 - getEccentricity());
+}
+
+double KeplerOrbit::getApoapsis() const
+{
+    if (!isBound()) return -1.0;
+    return getSemiMajorAxis() * (1.0 + getEccentricity());
+}
+
+double KeplerOrbit::getTrueAnomalyAtEpoch() const
+{
+    double along = periapsisDirection.x * epochPosition.x + periapsisDirection.y * epochPosition.y;
+    double across = periapsisDirection.x * epochPosition.y - periapsisDirection.y * epochPosition.x;
+    return std::atan2(turn * across, along);
+}
+
+double KeplerOrbit::getAsymptoteAnomaly() const
+{
+    if (eccentricity < 1.0) return std::numeric_limits<double>::infinity();
+    return std::acos(-1.0 / eccentricity);
+}
+
+Vector2d KeplerOrbit::positionAtTrueAnomaly(double trueAnomaly) const
+{
+    double r = semiLatusRectum / (1.0 + eccentricity * std::cos(trueAnomaly));
+    double c = std::cos(trueAnomaly);
+    double s = turn * std::sin(trueAnomaly);
+    return Vector2d(periapsisDirection.x * c - periapsisDirection.y * s,
+        periapsisDirection.x * s + periapsisDirection.y * c) * r;
+}
+
+double KeplerOrbit::timeAtTrueAnomaly(double trueAnomaly) const
+{
+    const double e = eccentricity;
+    if (e < 1.0 - CONIC_EPSILON) {
+        // Eccentric anomaly of the angle within one revolution, then whole revolutions on top
+        double revolutions = std::round(trueAnomaly / (2.0 * PI));
+        double within = trueAnomaly - 2.0 * PI * revolutions;
+        double E = 2.0 * std::atan(std::sqrt((1.0 - e) / (1.0 + e)) * std::tan(0.5 * within));
+        double meanAnomaly = E - e * std::sin(E) + 2.0 * PI * revolutions;
+        return meanAnomaly / std::sqrt(mu * alpha * alpha * alpha);
+    }
+    if (e > 1.0 + CONIC_EPSILON) {
+        double F = 2.0 * std::atanh(std::sqrt((e - 1.0) / (e + 1.0)) * std::tan(0.5 * trueAnomaly));
+        double meanAnomaly = e * std::sinh(F) - F;
+        return meanAnomaly / std::sqrt(-mu * alpha * alpha * alpha);
+    }
+
+    // Barker's equation for a parabola
+    double D = std::tan(0.5 * trueAnomaly);
+    return 0.5 * std::sqrt(semiLatusRectum * semiLatusRectum * semiLatusRectum / mu) * (D + D * D * D / 3.0);
+}
+
+double KeplerOrbit::timeAt(double trueAnomaly) const
+{
+    return epochTime + timeAtTrueAnomaly(trueAnomaly) - timeAtTrueAnomaly(getTrueAnomalyAtEpoch());
+}
\ No newline at end of file
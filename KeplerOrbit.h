@@ -0,0 +1,47 @@
+// KeplerOrbit.h
+#pragma once
+#include "VectorHelper.h"
+
+// Two-body orbit around a central body, propagated analytically from an epoch state.
+// Uses universal variables so ellipses, parabolas and hyperbolas share one code path.
+class KeplerOrbit {
+private:
+    double mu = 0.0;            // G * central mass
+    Vector2d epochPosition;     // Relative to the central body
+    Vector2d epochVelocity;
+    double epochTime = 0.0;
+    double alpha = 0.0;         // 1 / semi-major axis; > 0 bound, < 0 hyperbolic
+    double period = 0.0;        // 0 for open orbits
+    double eccentricity = 0.0;
+    double semiLatusRectum = 0.0;
+    Vector2d periapsisDirection;    // Unit vector; the epoch direction for a circular orbit
+    double turn = 1.0;              // +1 if the body moves anticlockwise in x-y, -1 otherwise
+
+public:
+    KeplerOrbit() = default;
+    KeplerOrbit(const Vector2d& relativePosition, const Vector2d& relativeVelocity, double gravitationalParameter, double time = 0.0);
+
+    // Relative position and velocity at an absolute time
+    void stateAt(double time, Vector2d& relativePosition, Vector2d& relativeVelocity) const;
+
+    bool isBound() const { return alpha > 0.0; }
+    double getPeriod() const { return period; }
+    double getSemiMajorAxis() const;
+    double getEccentricity() const;
+    // Closest and farthest distance from the central body; apoapsis is -1 for open orbits
+    double getPeriapsis() const;
+    double getApoapsis() const;
+
+    // Conic geometry. The true anomaly is measured from periapsis in the direction of motion
+    // and keeps counting past 2 pi on a bound orbit, so later points have larger anomalies.
+    double getSemiLatusRectum() const { return semiLatusRectum; }
+    const Vector2d& getPeriapsisDirection() const { return periapsisDirection; }
+    double getTrueAnomalyAtEpoch() const;
+    // Largest true anomaly an open orbit approaches; infinity for a bound one
+    double getAsymptoteAnomaly() const;
+    Vector2d positionAtTrueAnomaly(double trueAnomaly) const;
+    // Time from periapsis passage to a true anomaly
+    double timeAtTrueAnomaly(double trueAnomaly) const;
+    // Absolute time at which the body reaches a true anomaly, going forward from the epoch
+    double timeAt(double trueAnomaly) const;
+};
\ No newline at end of file
@@ -0,0 +1,168 @@
+// OrbitPathCache.cpp
+#include "OrbitPathCache.h"
+#include "GameConstants.h"
+#include "GravitySimulator.h"
+#include "KeplerOrbit.h"
+#include "Planet.h"
+#include "PolylineLod.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    // Vertex count limits for one ellipse, whatever the zoom
+    constexpr int MIN_ORBIT_SEGMENTS = 32;
+    constexpr int MAX_ORBIT_SEGMENTS = 4096;
+}
+
+const Planet* OrbitPathCache::findParent(const std::vector<Planet*>& planets, const Planet* planet)
+{
+    const Planet* parent = nullptr;
+    double strongestPull = 0.0;
+    for (const Planet* other : planets) {
+        if (other == planet || other->getMass() <= planet->getMass()) continue;
+        Vector2d offset = other->getWorldPosition() - planet->getWorldPosition();
+        double distanceSquared = offset.x * offset.x + offset.y * offset.y;
+        if (distanceSquared <= 0.0) continue;
+        double pull = other->getMass() / distanceSquared;
+        if (pull > strongestPull) {
+            strongestPull = pull;
+            parent = other;
+        }
+    }
+    return parent;
+}
+
+double OrbitPathCache::perturbation(const std::vector<Planet*>& planets, const Planet* planet, const Planet* parent,
+    double mu, double time)
+{
+    const double G = GameConstants::G;
+    auto pullOn = [&](const Planet* body) {
+        Vector2d acceleration;
+        for (const Planet* other : planets) {
+            if (other == body) continue;
+            Vector2d offset = other->getWorldPosition() - body->getWorldPosition();
+            double distanceSquared = offset.x * offset.x + offset.y * offset.y;
+            if (distanceSquared <= 0.0) continue;
+            acceleration += offset * (G * other->getMass() / (distanceSquared * std::sqrt(distanceSquared)));
+        }
+        return acceleration;
+    };
+
+    // What actually accelerates the parent: nothing when pinned, its path when prescribed
+    Vector2d parentAcceleration;
+    if (parent->getMotionSource() == MotionSource::DYNAMIC) {
+        parentAcceleration = pullOn(parent);
+    }
+    else if (parent->getMotionSource() == MotionSource::PRESCRIBED) {
+        const double h = 0.01;
+        Vector2d position, before, after;
+        parent->getPrescribedState(time - h, position, before);
+        parent->getPrescribedState(time + h, position, after);
+        parentAcceleration = (after - before) / (2.0 * h);
+    }
+
+    Vector2d offset = planet->getWorldPosition() - parent->getWorldPosition();
+    double distanceSquared = offset.x * offset.x + offset.y * offset.y;
+    double distance = std::sqrt(distanceSquared);
+    Vector2d residual = pullOn(planet) - parentAcceleration + offset * (mu / (distanceSquared * distance));
+    return std::sqrt(residual.x * residual.x + residual.y * residual.y) * distanceSquared / mu;
+}
+
+void OrbitPathCache::tessellate(double semiMajorAxis, double eccentricity, double tolerance, sf::Color color,
+    sf::VertexArray& vertices)
+{
+    // Even steps in eccentric anomaly; a chord of angle d on a circle of radius a strays a d^2 / 8
+    double segments = 2.0 * PI * std::sqrt(semiMajorAxis / (8.0 * std::max(tolerance, 1e-9)));
+    int count = std::clamp(static_cast<int>(std::ceil(segments)), MIN_ORBIT_SEGMENTS, MAX_ORBIT_SEGMENTS);
+
+    const double semiMinorAxis = semiMajorAxis * std::sqrt(std::max(0.0, 1.0 - eccentricity * eccentricity));
+    vertices.clear();
+    for (int i = 0; i <= count; i++) {
+        double anomaly = 2.0 * PI * static_cast<double>(i) / count;
+
+        // Focus at the origin, so the parent planet sits there
+        sf::Vertex point;
+        point.position = sf::Vector2f(static_cast<float>(semiMajorAxis * (std::cos(anomaly) - eccentricity)),
+            static_cast<float>(semiMinorAxis * std::sin(anomaly)));
+        point.color = color;
+        vertices.append(point);
+    }
+}
+
+void OrbitPathCache::draw(sf::RenderWindow& window, GravitySimulator& simulator)
+{
+    const std::vector<Planet*>& planets = simulator.getPlanets();
+    if (entries.size() != planets.size()) {
+        entries.resize(planets.size());
+    }
+
+    const double pixelSize = PolylineLod::getPixelSize(window);
+    const ViewBounds bounds = PolylineLod::getViewBounds(window, GameConstants::POLYLINE_LOD_MARGIN);
+
+    for (size_t i = 0; i < planets.size(); i++) {
+        Planet* planet = planets[i];
+        Entry& entry = entries[i];
+        if (entry.planet != planet) {
+            entry = Entry();
+            entry.planet = planet;
+        }
+
+        // Pinned planets don't move, and the heaviest planet has nothing to go round
+        if (planet->getMotionSource() == MotionSource::PINNED) continue;
+        const Planet* parent = findParent(planets, planet);
+        if (!parent) continue;
+
+        // A pinned or prescribed parent isn't pulled towards the planet, so only its own mass
+        // bends the orbit; two free planets both swing round their common centre of mass
+        double mu = static_cast<double>(GameConstants::G) * parent->getMass();
+        if (parent->getMotionSource() == MotionSource::DYNAMIC) {
+            mu += static_cast<double>(GameConstants::G) * planet->getMass();
+        }
+
+        // Two-body orbit of the planet around its parent as they are right now
+        KeplerOrbit orbit(planet->getWorldPosition() - parent->getWorldPosition(),
+            planet->getWorldVelocity() - parent->getWorldVelocity(), mu);
+        if (planet->getMotionSource() != MotionSource::DYNAMIC || !simulator.getSimulatePlanetGravity() ||
+            !orbit.isBound() ||
+            perturbation(planets, planet, parent, mu, simulator.getSimulationTime()) > GameConstants::ORBIT_PATH_MAX_PERTURBATION) {
+            planet->drawOrbitPath(window, simulator);
+            continue;
+        }
+
+        // Skip an ellipse that lies wholly outside the view or wholly around it
+        const Vector2d center = parent->getInterpolatedPosition();
+        double nearX = std::clamp(center.x, bounds.min.x, bounds.max.x) - center.x;
+        double nearY = std::clamp(center.y, bounds.min.y, bounds.max.y) - center.y;
+        double farX = std::max(std::abs(bounds.min.x - center.x), std::abs(bounds.max.x - center.x));
+        double farY = std::max(std::abs(bounds.min.y - center.y), std::abs(bounds.max.y - center.y));
+        double apoapsis = orbit.getApoapsis();
+        double periapsis = orbit.getPeriapsis();
+        if (nearX * nearX + nearY * nearY > apoapsis * apoapsis || farX * farX + farY * farY < periapsis * periapsis) {
+            continue;
+        }
+
+        // How far the cached ellipse is from the current one, at worst
+        double semiMajorAxis = orbit.getSemiMajorAxis();
+        double eccentricity = orbit.getEccentricity();
+        double drift = std::abs(semiMajorAxis - entry.semiMajorAxis) * (1.0 + eccentricity) +
+            semiMajorAxis * std::abs(eccentricity - entry.eccentricity);
+        bool zoomChanged = pixelSize < 0.5 * entry.pixelSize || pixelSize > 2.0 * entry.pixelSize;
+        if (entry.parent != parent || zoomChanged || drift > GameConstants::ORBIT_PATH_TOLERANCE * pixelSize) {
+            sf::Color color = planet->getColor();
+            tessellate(semiMajorAxis, eccentricity, GameConstants::POLYLINE_LOD_TOLERANCE * pixelSize,
+                sf::Color(color.r, color.g, color.b, 100), entry.vertices); // Semi-transparent version of planet color
+            entry.parent = parent;
+            entry.semiMajorAxis = semiMajorAxis;
+            entry.eccentricity = eccentricity;
+            entry.pixelSize = pixelSize;
+        }
+
+        // Orbit frame to render space: turn periapsis into place, then move onto the parent
+        const Vector2d& periapsisDirection = orbit.getPeriapsisDirection();
+        sf::RenderStates states;
+        states.transform.translate(parent->getRenderPosition());
+        states.transform.rotate(sf::radians(static_cast<float>(std::atan2(periapsisDirection.y, periapsisDirection.x))));
+        window.draw(entry.vertices, states);
+    }
+}
\ No newline at end of file
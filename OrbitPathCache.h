@@ -0,0 +1,47 @@
+// OrbitPathCache.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "VectorHelper.h"
+#include <vector>
+
+class GravitySimulator;
+class Planet;
+
+// Orbit lines for every planet, drawn from ellipses tessellated once and kept in each orbit's
+// own frame: the parent planet at the origin and periapsis along +x. A frame only places them
+// with a transform, so the whole set costs about as much as a handful of draw calls. An ellipse
+// is rebuilt when the planet's orbit changes shape by more than ORBIT_PATH_TOLERANCE pixels -
+// a mass change, a burn, a close pass - or the zoom level moves far enough to need a different
+// number of vertices. A slowly turning periapsis only turns the transform.
+class OrbitPathCache {
+private:
+    struct Entry {
+        const Planet* planet = nullptr;     // Identity only; entries are matched by pointer
+        const Planet* parent = nullptr;
+        double semiMajorAxis = 0.0;
+        double eccentricity = 0.0;
+        double pixelSize = 0.0;             // World units per pixel the ellipse was tessellated for
+        sf::VertexArray vertices{ sf::PrimitiveType::LineStrip };
+    };
+
+    std::vector<Entry> entries;             // Same order as the simulator's planets
+
+    // The planet a planet orbits: the heavier one pulling hardest on it, or none for the heaviest
+    static const Planet* findParent(const std::vector<Planet*>& planets, const Planet* planet);
+    // How far the planet's acceleration relative to its parent is from the Kepler pull mu / r^2,
+    // as a fraction of it: the other planets' tides and any acceleration of a prescribed parent
+    static double perturbation(const std::vector<Planet*>& planets, const Planet* planet, const Planet* parent,
+        double mu, double time);
+    // Closed ellipse around the origin, periapsis along +x, with chords within tolerance
+    static void tessellate(double semiMajorAxis, double eccentricity, double tolerance, sf::Color color,
+        sf::VertexArray& vertices);
+
+public:
+    // Draw the orbit of every planet that has one. A planet that isn't bound to its parent,
+    // or isn't a clean two-body case - prescribed, perturbed by a third planet, or coasting
+    // with planet gravity off - has no ellipse to cache and falls back to Planet::drawOrbitPath,
+    // which follows the ephemeris.
+    void draw(sf::RenderWindow& window, GravitySimulator& simulator);
+
+    void clear() { entries.clear(); }
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+// ParticlePool.cpp
+#include "ParticlePool.h"
+#include "GameConstants.h"
+#include "GameObject.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+ParticlePool::ParticlePool()
+    : vertices(sf::PrimitiveType::Points)
+{
+}
+
+size_t ParticlePool::add(const Vector2d& position, const Vector2d& velocity, float life)
+{
+    x.push_back(position.x);
+    y.push_back(position.y);
+    vx.push_back(velocity.x);
+    vy.push_back(velocity.y);
+    previousX.push_back(position.x);
+    previousY.push_back(position.y);
+    lifetime.push_back(life);
+    hit.push_back(0);
+    return x.size() - 1;
+}
+
+void ParticlePool::addRing(const Vector2d& center, const Vector2d& centerVelocity, double centralMass,
+    double innerRadius, double outerRadius, size_t count, unsigned int seed)
+{
+    const double pi = 3.14159265358979323846;
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> angleDistribution(0.0, 2.0 * pi);
+    // Uniform in area, so the belt isn't crowded at its inner edge
+    std::uniform_real_distribution<double> areaDistribution(innerRadius * innerRadius, outerRadius * outerRadius);
+
+    for (size_t i = 0; i < count; i++) {
+        double angle = angleDistribution(random);
+        double r = std::sqrt(areaDistribution(random));
+        double speed = std::sqrt(static_cast<double>(GameConstants::G) * centralMass / r);
+        Vector2d offset(std::cos(angle) * r, std::sin(angle) * r);
+        Vector2d tangent(-std::sin(angle) * speed, std::cos(angle) * speed);
+        add(center + offset, centerVelocity + tangent);
+    }
+}
+
+void ParticlePool::clear()
+{
+    for (std::vector<double>* column : { &x, &y, &vx, &vy, &previousX, &previousY }) {
+        column->clear();
+    }
+    lifetime.clear();
+    hit.clear();
+}
+
+void ParticlePool::beginStep()
+{
+    previousX = x;
+    previousY = y;
+}
+
+void ParticlePool::kick(const GravitySources& sources, double G, float deltaTime, JobSystem& jobs)
+{
+    const size_t count = x.size();
+    accelX.assign(count, 0.0);
+    accelY.assign(count, 0.0);
+
+    // Particles are independent, so chunks of them run on the pool without locking
+    jobs.parallelFor(count, GameConstants::PARTICLE_JOB_GRAIN, [&](size_t begin, size_t end) {
+        GravityKernel::accumulateOnPoints(sources, x.data() + begin, y.data() + begin, end - begin,
+            G, 0.0, accelX.data() + begin, accelY.data() + begin, hit.data() + begin);
+        for (size_t i = begin; i < end; i++) {
+            vx[i] += accelX[i] * deltaTime;
+            vy[i] += accelY[i] * deltaTime;
+        }
+    });
+}
+
+void ParticlePool::drift(float deltaTime)
+{
+    const size_t count = x.size();
+    for (size_t i = 0; i < count; i++) {
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+    }
+}
+
+void ParticlePool::removeAt(size_t i)
+{
+    // Swap with the last particle - order carries no meaning here
+    const size_t last = x.size() - 1;
+    x[i] = x[last];
+    y[i] = y[last];
+    vx[i] = vx[last];
+    vy[i] = vy[last];
+    previousX[i] = previousX[last];
+    previousY[i] = previousY[last];
+    lifetime[i] = lifetime[last];
+    hit[i] = hit[last];
+
+    for (std::vector<double>* column : { &x, &y, &vx, &vy, &previousX, &previousY }) {
+        column->pop_back();
+    }
+    lifetime.pop_back();
+    hit.pop_back();
+}
+
+void ParticlePool::endStep(float deltaTime)
+{
+    size_t i = 0;
+    while (i < x.size()) {
+        bool expired = false;
+        if (lifetime[i] > 0.0f) {
+            lifetime[i] -= deltaTime;
+            expired = lifetime[i] <= 0.0f;
+        }
+        if (hit[i] || expired) {
+            removeAt(i);
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+void ParticlePool::draw(sf::RenderWindow& window, float renderAlpha)
+{
+    const size_t count = x.size();
+    vertices.resize(count);
+    const double alpha = static_cast<double>(renderAlpha);
+    for (size_t i = 0; i < count; i++) {
+        Vector2d world(previousX[i] + (x[i] - previousX[i]) * alpha,
+            previousY[i] + (y[i] - previousY[i]) * alpha);
+        vertices[i].position = GameObject::toRenderSpace(world);
+        vertices[i].color = color;
+    }
+    window.draw(vertices);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+// ParticlePool.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "GravityKernel.h"
+#include "JobSystem.h"
+#include "VectorHelper.h"
+#include <vector>
+
+// Massless test particles - belt rocks, debris, exhaust - packed as structure-of-arrays.
+// They feel gravity but exert none, so a step costs particles x planets rather than n^2,
+// and the kernel runs across particles instead of across sources.
+class ParticlePool {
+private:
+    std::vector<double> x, y, vx, vy;
+    std::vector<double> previousX, previousY;   // Positions at the start of the last step, for drawing
+    std::vector<float> lifetime;                // Seconds left; zero or less lives forever
+    std::vector<unsigned char> hit;             // Set when a particle ends up inside a source
+
+    // Scratch accelerations, one entry per particle
+    std::vector<double> accelX, accelY;
+
+    sf::Color color = sf::Color(170, 160, 150);
+    sf::VertexArray vertices;
+
+    void removeAt(size_t i);
+
+public:
+    ParticlePool();
+
+    size_t add(const Vector2d& position, const Vector2d& velocity, float life = -1.0f);
+    // Scatter particles on circular orbits between two radii of a body - an asteroid belt
+    void addRing(const Vector2d& center, const Vector2d& centerVelocity, double centralMass,
+        double innerRadius, double outerRadius, size_t count, unsigned int seed = 1);
+    void clear();
+
+    // Integrator stages. kick() adds the pull of the sources over dt; particles that fall
+    // inside a source are marked and removed by the next endStep.
+    void beginStep();
+    void kick(const GravitySources& sources, double G, float deltaTime, JobSystem& jobs);
+    void drift(float deltaTime);
+    void endStep(float deltaTime);
+
+    // Particles drawn as points between their last two positions
+    void draw(sf::RenderWindow& window, float renderAlpha);
+
+    void setColor(sf::Color newColor) { color = newColor; }
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    Vector2d getPosition(size_t i) const { return Vector2d(x[i], y[i]); }
+    Vector2d getVelocity(size_t i) const { return Vector2d(vx[i], vy[i]); }
+};
\ No newline at end of file
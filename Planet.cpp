@@ -1,7 +1,10 @@
 #include "Planet.h"
 #include "VectorHelper.h"
 #include "GameConstants.h"
+#include "GravitySimulator.h"
+#include "PolylineLod.h"
 #include <cmath>
+#include <utility>
 
 Planet::Planet(sf::Vector2f pos, float radius, float mass, sf::Color color)
     : GameObject(pos, { 0, 0 }, color), mass(mass)
@@ -18,17 +21,18 @@ Planet::Planet(sf::Vector2f pos, float radius, float mass, sf::Color color)
     shape.setRadius(this->radius);
     shape.setFillColor(color);
     shape.setOrigin({ this->radius, this->radius });
-    shape.setPosition(position);
+    shape.setPosition(getRenderPosition());
 }
 
 void Planet::update(float deltaTime)
 {
-    position += velocity * deltaTime;
-    shape.setPosition(position);
+    // Position and velocity are advanced by GravitySimulator's integrator,
+    // and draw() places the shape at the interpolated position
 }
 
 void Planet::draw(sf::RenderWindow& window)
 {
+    shape.setPosition(getRenderPosition());
     window.draw(shape);
 }
 
@@ -48,6 +52,38 @@ void Planet::setMass(float newMass)
     updateRadiusFromMass();
 }
 
+void Planet::setPrescribedPath(PrescribedPath path)
+{
+    prescribedPath = std::move(path);
+    motionSource = MotionSource::PRESCRIBED;
+}
+
+void Planet::getPrescribedState(double time, Vector2d& pos, Vector2d& vel) const
+{
+    if (prescribedPath) {
+        prescribedPath(time, pos, vel);
+    }
+    else {
+        // No path yet - hold the current state
+        pos = position;
+        vel = velocity;
+    }
+}
+
+PrescribedPath Planet::getPrescribedPath() const
+{
+    if (prescribedPath) {
+        return prescribedPath;
+    }
+
+    Vector2d heldPosition = position;
+    Vector2d heldVelocity = velocity;
+    return [heldPosition, heldVelocity](double, Vector2d& pos, Vector2d& vel) {
+        pos = heldPosition;
+        vel = heldVelocity;
+    };
+}
+
 void Planet::updateRadiusFromMass()
 {
     // Use cube root relationship between mass and radius
@@ -64,63 +100,54 @@ void Planet::drawVelocityVector(sf::RenderWindow& window, float scale)
     sf::VertexArray line(sf::PrimitiveType::LineStrip);
 
     sf::Vertex startVertex;
-    startVertex.position = position;
+    startVertex.position = getRenderPosition();
     startVertex.color = sf::Color::Yellow;
     line.append(startVertex);
 
     sf::Vertex endVertex;
-    endVertex.position = position + velocity * scale;
+    endVertex.position = startVertex.position + sf::Vector2f(velocity) * scale;
     endVertex.color = sf::Color::Green;
     line.append(endVertex);
 
     window.draw(line);
 }
 
-void Planet::drawOrbitPath(sf::RenderWindow& window, const std::vector<Planet*>& planets,
-    float timeStep, int steps)
+void Planet::drawOrbitPath(sf::RenderWindow& window, GravitySimulator& simulator, float timeStep, int steps)
 {
-    // Create a vertex array for the trajectory line
-    sf::VertexArray trajectory(sf::PrimitiveType::LineStrip);
+    PlanetEphemeris& ephemeris = simulator.getEphemeris();
+    const double startTime = simulator.getSimulationTime();
+    const int self = ephemeris.indexOf(this);
+    if (self < 0) {
+        return;
+    }
 
-    // Start with current position and velocity
-    sf::Vector2f simPosition = position;
-    sf::Vector2f simVelocity = velocity;
+    // Points of the trajectory line in world space
+    std::vector<PolylinePoint> path;
+    path.reserve(steps + 1);
 
     // Add the starting point
-    sf::Vertex startPoint;
-    startPoint.position = simPosition;
-    startPoint.color = sf::Color(color.r, color.g, color.b, 100); // Semi-transparent version of planet color
-    trajectory.append(startPoint);
+    path.push_back({ ephemeris.positionAt(self, startTime),
+        sf::Color(color.r, color.g, color.b, 100) }); // Semi-transparent version of planet color
 
-    // Simulate future positions
+    // Future positions come straight from the table, which already moves every planet
     for (int i = 0; i < steps; i++) {
-        // Calculate gravitational forces from all planets
-        sf::Vector2f totalAcceleration(0, 0);
-
-        for (const auto& otherPlanet : planets) {
-            // Skip self
-            if (otherPlanet == this) continue;
-
-            sf::Vector2f direction = otherPlanet->getPosition() - simPosition;
-            float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-            // Skip if too close
-            if (distance <= otherPlanet->getRadius() + radius + GameConstants::TRAJECTORY_COLLISION_RADIUS) {
-                // Stop the trajectory if we hit another planet
+        double time = startTime + static_cast<double>(i + 1) * timeStep;
+        Vector2d simPosition = ephemeris.positionAt(self, time);
+
+        // Stop the path if we hit another planet
+        bool hitPlanet = false;
+        for (size_t j = 0; j < ephemeris.getPlanetCount(); j++) {
+            if (static_cast<int>(j) == self) continue;
+            double reach = ephemeris.getRadius(j) + radius + GameConstants::TRAJECTORY_COLLISION_RADIUS;
+            Vector2d offset = ephemeris.positionAt(j, time) - simPosition;
+            if (offset.x * offset.x + offset.y * offset.y < reach * reach) {
+                hitPlanet = true;
                 break;
             }
-
-            // Use same gravitational constant as in GravitySimulator
-            const float G = GameConstants::G;  // Use the constant from the header
-            float forceMagnitude = G * otherPlanet->getMass() * mass / (distance * distance);
-
-            sf::Vector2f acceleration = normalize(direction) * forceMagnitude / mass;
-            totalAcceleration += acceleration;
         }
-
-        // Update simulated velocity and position
-        simVelocity += totalAcceleration * timeStep;
-        simPosition += simVelocity * timeStep;
+        if (hitPlanet) {
+            break;
+        }
 
         // Calculate fade-out effect
         float alpha = 255 * (1.0f - static_cast<float>(i) / steps);
@@ -128,12 +155,14 @@ void Planet::drawOrbitPath(sf::RenderWindow& window, const std::vector<Planet*>&
         sf::Color pointColor(color.r, color.g, color.b, static_cast<uint8_t>(alpha));
 
         // Add point to trajectory
-        sf::Vertex point;
-        point.position = simPosition;
-        point.color = pointColor;
-        trajectory.append(point);
+        path.push_back({ simPosition, pointColor });
     }
 
+    // Keep only what is on screen, at the detail the zoom level can show
+    sf::VertexArray trajectory(sf::PrimitiveType::LineStrip);
+    PolylineLod::appendLineStrip(path, PolylineLod::getViewBounds(window, GameConstants::POLYLINE_LOD_MARGIN),
+        GameConstants::POLYLINE_LOD_TOLERANCE * PolylineLod::getPixelSize(window), getRenderOrigin(), trajectory);
+
     // Draw the trajectory
     window.draw(trajectory);
 }
\ No newline at end of file
@@ -1,16 +1,31 @@
 #pragma once
 #include "GameObject.h"
+#include <functional>
 #include <vector>
 
+class GravitySimulator;
+
+// What moves a planet
+enum class MotionSource {
+    DYNAMIC,     // The gravity of the other planets
+    PINNED,      // Nothing - it stays where it is
+    PRESCRIBED   // A path given as a function of simulation time
+};
+
+// Position and velocity of a prescribed planet at a simulation time
+using PrescribedPath = std::function<void(double time, Vector2d& position, Vector2d& velocity)>;
+
 class Planet : public GameObject {
 private:
     sf::CircleShape shape;
     float mass;
     float radius;
+    MotionSource motionSource = MotionSource::DYNAMIC;
+    PrescribedPath prescribedPath;
 
 public:
     Planet(sf::Vector2f pos, float radius, float mass, sf::Color color = sf::Color::Blue);
-    void setPosition(const sf::Vector2f& pos) { position = pos; }
+    void setPosition(const sf::Vector2f& pos) { setWorldPosition(Vector2d(pos)); }
     sf::Color getColor() const { return color; }
     void update(float deltaTime) override;
     void draw(sf::RenderWindow& window) override;
@@ -21,6 +36,16 @@ public:
     float getMass() const;
     float getRadius() const;
 
+    // Pinned and prescribed planets still attract, but gravity never moves them
+    void setMotionSource(MotionSource source) { motionSource = source; }
+    MotionSource getMotionSource() const { return motionSource; }
+    bool isKinematic() const { return motionSource != MotionSource::DYNAMIC; }
+    void setPrescribedPath(PrescribedPath path);
+    void getPrescribedState(double time, Vector2d& pos, Vector2d& vel) const;
+    // The path itself, for keeping a copy that doesn't depend on this planet staying alive;
+    // without one it holds the current state
+    PrescribedPath getPrescribedPath() const;
+
     // New methods for dynamic radius
     void setMass(float newMass);
     void updateRadiusFromMass();
@@ -28,7 +53,7 @@ public:
     // Draw velocity vector for the planet
     void drawVelocityVector(sf::RenderWindow& window, float scale = 1.0f);
 
-    // Draw predicted orbit path
-    void drawOrbitPath(sf::RenderWindow& window, const std::vector<Planet*>& planets, float timeStep = 0.5f, int steps = 200);
+    // Draw predicted orbit path, read from the simulator's ephemeris
+    void drawOrbitPath(sf::RenderWindow& window, GravitySimulator& simulator, float timeStep = 0.5f, int steps = 200);
 
 };
\ No newline at end of file
@@ -0,0 +1,312 @@
+// PlanetEphemeris.cpp
+#include "PlanetEphemeris.h"
+#include "Integrator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Samples behind the current time are dropped in chunks so the erase stays rare
+    constexpr long long DISCARD_CHUNK = 256;
+}
+
+PlanetEphemeris::PlanetEphemeris()
+    : sampleInterval(GameConstants::EPHEMERIS_SAMPLE_INTERVAL)
+{
+}
+
+void PlanetEphemeris::computeAccelerations(const double* px, const double* py, double* outX, double* outY)
+{
+    const size_t count = planets.size();
+    std::fill(outX, outX + count, 0.0);
+    std::fill(outY, outY + count, 0.0);
+    if (!planetGravity || dynamicPlanets.empty()) {
+        return;
+    }
+
+    const bool useTree = solver == GravitySolver::BARNES_HUT;
+    if (useTree) {
+        tree.setOpeningAngle(openingAngle);
+        tree.build(px, py, mass.data(), radius.data(), count);
+    }
+
+    // Every planet attracts; only the dynamic ones are pulled. The overlap test skips itself.
+    // Each planet's sum is formed whole inside one chunk, so the table doesn't depend on the
+    // number of threads.
+    GravitySources sources = { px, py, mass.data(), radius.data(), count };
+    jobs->parallelFor(dynamicPlanets.size(), GameConstants::GRAVITY_JOB_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            size_t j = dynamicPlanets[t];
+            if (useTree) {
+                Vector2d acceleration = tree.accelerationAt(Vector2d(px[j], py[j]), GameConstants::G,
+                    static_cast<int>(j), radius[j]);
+                outX[j] = acceleration.x;
+                outY[j] = acceleration.y;
+            }
+            else {
+                GravityKernel::accumulate(sources, px[j], py[j], GameConstants::G, radius[j], 0.0, outX[j], outY[j]);
+            }
+        }
+    });
+}
+
+void PlanetEphemeris::placePrescribed(double time)
+{
+    for (size_t j : prescribedPlanets) {
+        Vector2d position;
+        Vector2d velocity;
+        paths[j](time, position, velocity);
+        workX[j] = position.x;
+        workY[j] = position.y;
+        workVX[j] = velocity.x;
+        workVY[j] = velocity.y;
+    }
+}
+
+void PlanetEphemeris::appendSample()
+{
+    const size_t count = planets.size();
+    const size_t base = x.size();
+    x.insert(x.end(), workX.begin(), workX.end());
+    y.insert(y.end(), workY.begin(), workY.end());
+    vx.insert(vx.end(), workVX.begin(), workVX.end());
+    vy.insert(vy.end(), workVY.begin(), workVY.end());
+    ax.resize(base + count);
+    ay.resize(base + count);
+    computeAccelerations(workX.data(), workY.data(), ax.data() + base, ay.data() + base);
+    sampleCount++;
+}
+
+void PlanetEphemeris::extendTo(long long sample)
+{
+    const size_t count = planets.size();
+    std::vector<double> accelX(count), accelY(count);
+
+    // Fourth order with small substeps - this runs once per sample, not once per consumer
+    auto kick = [&](float dt) {
+        computeAccelerations(workX.data(), workY.data(), accelX.data(), accelY.data());
+        for (size_t j : dynamicPlanets) {
+            workVX[j] += accelX[j] * dt;
+            workVY[j] += accelY[j] * dt;
+        }
+    };
+    auto drift = [&](float dt) {
+        for (size_t j : dynamicPlanets) {
+            workX[j] += workVX[j] * dt;
+            workY[j] += workVY[j] * dt;
+        }
+        workTime += dt;
+        placePrescribed(workTime);
+    };
+
+    const float substep = static_cast<float>(sampleInterval / GameConstants::EPHEMERIS_SUBSTEPS);
+    while (firstSample + sampleCount <= sample) {
+        for (int s = 0; s < GameConstants::EPHEMERIS_SUBSTEPS; s++) {
+            Integrator::stepWith(IntegratorType::YOSHIDA4, substep, kick, drift);
+        }
+
+        // Prescribed planets land exactly on the sample time
+        workTime = epoch + static_cast<double>(firstSample + sampleCount) * sampleInterval;
+        placePrescribed(workTime);
+        appendSample();
+    }
+}
+
+void PlanetEphemeris::discardBeforeSample(long long sample)
+{
+    long long drop = sample - firstSample;
+    if (drop < DISCARD_CHUNK || drop >= sampleCount) return;
+
+    const size_t values = static_cast<size_t>(drop) * planets.size();
+    for (std::vector<double>* column : { &x, &y, &vx, &vy, &ax, &ay }) {
+        column->erase(column->begin(), column->begin() + values);
+    }
+    firstSample += drop;
+    sampleCount -= drop;
+}
+
+void PlanetEphemeris::rebuild(const std::vector<Planet*>& newPlanets, double time, bool enablePlanetGravity,
+    GravitySolver newSolver, float newOpeningAngle)
+{
+    planets.assign(newPlanets.begin(), newPlanets.end());
+    planetGravity = enablePlanetGravity;
+    solver = newSolver;
+    openingAngle = newOpeningAngle;
+    revision++;
+    mass.clear();
+    radius.clear();
+    motion.clear();
+    paths.clear();
+    dynamicPlanets.clear();
+    prescribedPlanets.clear();
+    workX.clear();
+    workY.clear();
+    workVX.clear();
+    workVY.clear();
+    for (size_t j = 0; j < planets.size(); j++) {
+        const Planet* planet = planets[j];
+        MotionSource source = planet->getMotionSource();
+        mass.push_back(planet->getMass());
+        radius.push_back(planet->getRadius());
+        motion.push_back(source);
+        paths.push_back(source == MotionSource::PRESCRIBED ? planet->getPrescribedPath() : PrescribedPath());
+        workX.push_back(planet->getWorldPosition().x);
+        workY.push_back(planet->getWorldPosition().y);
+
+        // A pinned planet has no velocity, whatever it was given
+        bool pinned = source == MotionSource::PINNED;
+        workVX.push_back(pinned ? 0.0 : planet->getWorldVelocity().x);
+        workVY.push_back(pinned ? 0.0 : planet->getWorldVelocity().y);
+
+        if (source == MotionSource::DYNAMIC) {
+            dynamicPlanets.push_back(j);
+        }
+        else if (source == MotionSource::PRESCRIBED) {
+            prescribedPlanets.push_back(j);
+        }
+    }
+    workTime = time;
+    placePrescribed(workTime);
+
+    for (std::vector<double>* column : { &x, &y, &vx, &vy, &ax, &ay }) {
+        column->clear();
+    }
+    epoch = time;
+    firstSample = 0;
+    sampleCount = 0;
+    appendSample();
+}
+
+bool PlanetEphemeris::matches(const std::vector<Planet*>& livePlanets, double time, bool enablePlanetGravity,
+    GravitySolver newSolver, float newOpeningAngle)
+{
+    if (sampleCount == 0 || planetGravity != enablePlanetGravity || livePlanets.size() != planets.size()) {
+        return false;
+    }
+    // A different solver gives slightly different forces, so the samples so far don't hold
+    if (solver != newSolver || (solver == GravitySolver::BARNES_HUT && openingAngle != newOpeningAngle)) {
+        return false;
+    }
+    for (size_t j = 0; j < planets.size(); j++) {
+        if (livePlanets[j] != planets[j] || static_cast<double>(livePlanets[j]->getMass()) != mass[j] ||
+            livePlanets[j]->getMotionSource() != motion[j]) {
+            return false;
+        }
+    }
+
+    // Consumers write back exactly what the table gives them, so a real difference is an outside
+    // change. Network states carry floats, so a client's planets are a little off the table on
+    // every packet even when nothing happened; that alone mustn't start every path over.
+    const double positionTolerance = GameConstants::EPHEMERIS_POSITION_TOLERANCE;
+    const double velocityTolerance = GameConstants::EPHEMERIS_VELOCITY_TOLERANCE;
+    for (size_t j = 0; j < planets.size(); j++) {
+        Vector2d position;
+        Vector2d velocity;
+        stateAt(j, time, position, velocity);
+        Vector2d positionError = position - planets[j]->getWorldPosition();
+        Vector2d velocityError = velocity - planets[j]->getWorldVelocity();
+        if (positionError.x * positionError.x + positionError.y * positionError.y > positionTolerance * positionTolerance ||
+            velocityError.x * velocityError.x + velocityError.y * velocityError.y > velocityTolerance * velocityTolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PlanetEphemeris::sync(const std::vector<Planet*>& livePlanets, double time, bool enablePlanetGravity,
+    GravitySolver newSolver, float newOpeningAngle)
+{
+    if (!matches(livePlanets, time, enablePlanetGravity, newSolver, newOpeningAngle)) {
+        rebuild(livePlanets, time, enablePlanetGravity, newSolver, newOpeningAngle);
+    }
+
+    discardBefore(time);
+}
+
+void PlanetEphemeris::discardBefore(double time)
+{
+    // Keep one sample of slack: some integrator stages step slightly backwards in time
+    long long current = static_cast<long long>(std::floor((time - epoch) / sampleInterval));
+    discardBeforeSample(current - 1);
+}
+
+void PlanetEphemeris::stateAt(size_t planet, double time, Vector2d& position, Vector2d& velocity)
+{
+    // Prescribed paths are exact at any time; the table only feeds them to the other planets
+    if (motion[planet] == MotionSource::PRESCRIBED) {
+        paths[planet](time, position, velocity);
+        return;
+    }
+
+    double s = (time - epoch) / sampleInterval;
+    long long k = static_cast<long long>(std::floor(s));
+    if (k < firstSample) {
+        k = firstSample;
+    }
+    extendTo(k + 1);
+    double u = s - static_cast<double>(k);
+
+    // Cubic Hermite basis over one sample interval
+    double u2 = u * u;
+    double u3 = u2 * u;
+    double h00 = 2.0 * u3 - 3.0 * u2 + 1.0;
+    double h10 = (u3 - 2.0 * u2 + u) * sampleInterval;
+    double h01 = -2.0 * u3 + 3.0 * u2;
+    double h11 = (u3 - u2) * sampleInterval;
+
+    const size_t a = static_cast<size_t>(k - firstSample) * planets.size() + planet;
+    const size_t b = a + planets.size();
+
+    // Positions from position and velocity, velocities from velocity and acceleration
+    position.x = h00 * x[a] + h10 * vx[a] + h01 * x[b] + h11 * vx[b];
+    position.y = h00 * y[a] + h10 * vy[a] + h01 * y[b] + h11 * vy[b];
+    velocity.x = h00 * vx[a] + h10 * ax[a] + h01 * vx[b] + h11 * ax[b];
+    velocity.y = h00 * vy[a] + h10 * ay[a] + h01 * vy[b] + h11 * ay[b];
+}
+
+void PlanetEphemeris::measureTreeError(double time, float theta, double& errorSquared, double& magnitudeSquared)
+{
+    const size_t count = planets.size();
+    std::vector<double> px(count), py(count);
+    for (size_t j = 0; j < count; j++) {
+        Vector2d position = positionAt(j, time);
+        px[j] = position.x;
+        py[j] = position.y;
+    }
+
+    // Both passes with the table's own settings otherwise, then those are put back
+    const GravitySolver selected = solver;
+    const float selectedAngle = openingAngle;
+    std::vector<double> exactX(count), exactY(count), treeX(count), treeY(count);
+    solver = GravitySolver::PAIRWISE;
+    computeAccelerations(px.data(), py.data(), exactX.data(), exactY.data());
+    solver = GravitySolver::BARNES_HUT;
+    openingAngle = theta;
+    computeAccelerations(px.data(), py.data(), treeX.data(), treeY.data());
+    solver = selected;
+    openingAngle = selectedAngle;
+
+    for (size_t j : dynamicPlanets) {
+        double dx = treeX[j] - exactX[j];
+        double dy = treeY[j] - exactY[j];
+        errorSquared += dx * dx + dy * dy;
+        magnitudeSquared += exactX[j] * exactX[j] + exactY[j] * exactY[j];
+    }
+}
+
+Vector2d PlanetEphemeris::positionAt(size_t planet, double time)
+{
+    Vector2d position;
+    Vector2d velocity;
+    stateAt(planet, time, position, velocity);
+    return position;
+}
+
+int PlanetEphemeris::indexOf(const Planet* planet) const
+{
+    for (size_t j = 0; j < planets.size(); j++) {
+        if (planets[j] == planet) {
+            return static_cast<int>(j);
+        }
+    }
+    return -1;
+}
\ No newline at end of file
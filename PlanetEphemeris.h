@@ -0,0 +1,87 @@
+// PlanetEphemeris.h
+#pragma once
+#include "BarnesHutTree.h"
+#include "GameConstants.h"
+#include "GravityKernel.h"
+#include "JobSystem.h"
+#include "Planet.h"
+#include "VectorHelper.h"
+#include <vector>
+
+// Planet motion integrated once at high accuracy into a time-indexed table, then sampled
+// with Hermite interpolation by the live simulation, trajectory previews and orbit paths.
+// Planets only pull on each other, so their future doesn't depend on any rocket. Their
+// forces use the simulator's solver and are spread over its job system.
+class PlanetEphemeris {
+private:
+    std::vector<const Planet*> planets;    // Only compared, never dereferenced outside sync
+    std::vector<double> mass;
+    std::vector<double> radius;
+    std::vector<MotionSource> motion;
+    std::vector<PrescribedPath> paths;      // Copied, so table copies on other threads stand alone
+    bool planetGravity = true;
+    GravitySolver solver = GravitySolver::PAIRWISE;
+    float openingAngle = GameConstants::BARNES_HUT_OPENING_ANGLE;
+    BarnesHutTree tree;                 // Of the positions being evaluated, under Barnes-Hut
+    JobSystem* jobs = &JobSystem::getShared();  // Copies on other threads share it too
+    unsigned long long revision = 0;    // Bumped by every rebuild
+
+    // Planets grouped by what moves them, so the passes below never branch per planet.
+    // Pinned planets are in neither list and simply keep their sample-0 state.
+    std::vector<size_t> dynamicPlanets;
+    std::vector<size_t> prescribedPlanets;
+
+    // Sample k is every planet's state at epoch + k * sampleInterval; planet j of the
+    // sample at index (k - firstSample) * planets.size() + j
+    double epoch = 0.0;
+    double sampleInterval = 0.0;
+    long long firstSample = 0;
+    long long sampleCount = 0;
+    std::vector<double> x, y, vx, vy, ax, ay;
+
+    // State after the last sample, integrated on to produce the next one
+    std::vector<double> workX, workY, workVX, workVY;
+    double workTime = 0.0;
+
+    void computeAccelerations(const double* px, const double* py, double* outX, double* outY);
+    void placePrescribed(double time);
+    void appendSample();
+    void extendTo(long long sample);
+    void discardBeforeSample(long long sample);
+    void rebuild(const std::vector<Planet*>& newPlanets, double time, bool enablePlanetGravity,
+        GravitySolver newSolver, float newOpeningAngle);
+    bool matches(const std::vector<Planet*>& livePlanets, double time, bool enablePlanetGravity,
+        GravitySolver newSolver, float newOpeningAngle);
+
+public:
+    PlanetEphemeris();
+
+    // Make the table describe these planets from this time on. It is rebuilt only if the
+    // planet set, a mass, the gravity setting or the solver changed, or a planet is further
+    // off the table than float network states explain (a teleport or a network correction).
+    void sync(const std::vector<Planet*>& livePlanets, double time, bool enablePlanetGravity = true,
+        GravitySolver newSolver = GravitySolver::PAIRWISE,
+        float newOpeningAngle = GameConstants::BARNES_HUT_OPENING_ANGLE);
+    void setJobSystem(JobSystem* system) { jobs = system; }
+    // Let go of samples before this time; nothing may read earlier than it afterwards.
+    // sync does this itself; a private copy that is only read calls it to stay bounded.
+    void discardBefore(double time);
+
+    // Interpolated state of a planet at an absolute time, extending the table as needed
+    void stateAt(size_t planet, double time, Vector2d& position, Vector2d& velocity);
+    Vector2d positionAt(size_t planet, double time);
+
+    // Squared error of the Barnes-Hut planet accelerations at this opening angle against the
+    // exact sum, and squared magnitude of the exact ones, added over the dynamic planets at
+    // a time. Runs the same force pass the table is integrated with.
+    void measureTreeError(double time, float theta, double& errorSquared, double& magnitudeSquared);
+
+    // Index of a planet in the table, or -1
+    int indexOf(const Planet* planet) const;
+    size_t getPlanetCount() const { return planets.size(); }
+    double getMass(size_t planet) const { return mass[planet]; }
+    double getRadius(size_t planet) const { return radius[planet]; }
+    size_t getSampleCount() const { return static_cast<size_t>(sampleCount); }
+    // Changes whenever the table is rebuilt, so anything derived from it knows to start over
+    unsigned long long getRevision() const { return revision; }
+};
\ No newline at end of file
@@ -0,0 +1,126 @@
+// PolylineLod.cpp
+#include "PolylineLod.h"
+#include "GameObject.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Squared distance from p to the segment from a to b
+    double distanceToSegmentSquared(const Vector2d& p, const Vector2d& a, const Vector2d& b)
+    {
+        Vector2d ab = b - a;
+        Vector2d ap = p - a;
+        double lengthSquared = ab.x * ab.x + ab.y * ab.y;
+        double t = lengthSquared > 0.0 ? (ap.x * ab.x + ap.y * ab.y) / lengthSquared : 0.0;
+        t = std::max(0.0, std::min(1.0, t));
+        Vector2d offset = ap - ab * t;
+        return offset.x * offset.x + offset.y * offset.y;
+    }
+
+    bool segmentVisible(const Vector2d& a, const Vector2d& b, const ViewBounds& bounds)
+    {
+        // Bounding box overlap - a superset, which only costs the odd vertex near a corner
+        return std::max(a.x, b.x) >= bounds.min.x && std::min(a.x, b.x) <= bounds.max.x &&
+            std::max(a.y, b.y) >= bounds.min.y && std::min(a.y, b.y) <= bounds.max.y;
+    }
+
+    // Douglas-Peucker over points[first..last]: mark the points the simplified line keeps.
+    // Uses an explicit stack, since a long spiral would otherwise recurse thousands deep.
+    void simplify(const std::vector<PolylinePoint>& points, size_t first, size_t last,
+        double toleranceSquared, std::vector<char>& keep)
+    {
+        keep[first] = 1;
+        keep[last] = 1;
+        std::vector<std::pair<size_t, size_t>> pending;
+        pending.push_back({ first, last });
+        while (!pending.empty()) {
+            auto [a, b] = pending.back();
+            pending.pop_back();
+
+            size_t farthest = a;
+            double worst = 0.0;
+            for (size_t i = a + 1; i < b; i++) {
+                double d = distanceToSegmentSquared(points[i].position, points[a].position, points[b].position);
+                if (d > worst) {
+                    worst = d;
+                    farthest = i;
+                }
+            }
+            if (worst > toleranceSquared) {
+                keep[farthest] = 1;
+                pending.push_back({ a, farthest });
+                pending.push_back({ farthest, b });
+            }
+        }
+    }
+
+    void appendVertex(sf::VertexArray& vertices, const Vector2d& position, sf::Color color, const Vector2d& origin)
+    {
+        sf::Vertex vertex;
+        vertex.position = sf::Vector2f(position - origin);
+        vertex.color = color;
+        vertices.append(vertex);
+    }
+}
+
+double PolylineLod::getPixelSize(const sf::RenderWindow& window)
+{
+    return static_cast<double>(window.getView().getSize().x) / window.getSize().x;
+}
+
+ViewBounds PolylineLod::getViewBounds(const sf::RenderWindow& window, float margin)
+{
+    // The view is in render space, centred relative to the render origin
+    const sf::View& view = window.getView();
+    Vector2d center = GameObject::getRenderOrigin() + Vector2d(view.getCenter());
+    Vector2d half = Vector2d(view.getSize()) * 0.5 + Vector2d(1.0, 1.0) * (margin * getPixelSize(window));
+    return { center - half, center + half };
+}
+
+void PolylineLod::appendLineStrip(const std::vector<PolylinePoint>& points, const ViewBounds& bounds,
+    double tolerance, const Vector2d& origin, sf::VertexArray& vertices)
+{
+    if (points.size() < 2) {
+        if (points.size() == 1 && segmentVisible(points[0].position, points[0].position, bounds)) {
+            appendVertex(vertices, points[0].position, points[0].color, origin);
+        }
+        return;
+    }
+
+    std::vector<char> keep(points.size(), 0);
+    const double toleranceSquared = tolerance * tolerance;
+    bool emitted = false;
+    size_t lastEmitted = 0;
+    size_t i = 0;
+    while (i + 1 < points.size()) {
+        // Next run of consecutive segments that touch the view
+        if (!segmentVisible(points[i].position, points[i + 1].position, bounds)) {
+            i++;
+            continue;
+        }
+        size_t first = i;
+        while (i + 1 < points.size() && segmentVisible(points[i].position, points[i + 1].position, bounds)) {
+            i++;
+        }
+        size_t last = i;
+
+        // Bridge from the previous run with an invisible segment
+        if (emitted) {
+            sf::Color hidden = points[lastEmitted].color;
+            hidden.a = 0;
+            appendVertex(vertices, points[lastEmitted].position, hidden, origin);
+            hidden = points[first].color;
+            hidden.a = 0;
+            appendVertex(vertices, points[first].position, hidden, origin);
+        }
+
+        simplify(points, first, last, toleranceSquared, keep);
+        for (size_t k = first; k <= last; k++) {
+            if (keep[k]) {
+                appendVertex(vertices, points[k].position, points[k].color, origin);
+            }
+        }
+        emitted = true;
+        lastEmitted = last;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+// PolylineLod.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "VectorHelper.h"
+#include <vector>
+
+// One point of a polyline to draw, in world coordinates
+struct PolylinePoint {
+    Vector2d position;
+    sf::Color color;
+};
+
+// World rectangle covered by a view
+struct ViewBounds {
+    Vector2d min;
+    Vector2d max;
+};
+
+// Screen-space level of detail for long polylines such as predicted paths. Parts outside
+// the view are dropped and the rest is simplified with Douglas-Peucker to a tolerance in
+// pixels, so the vertex count follows what is on screen instead of how the line was sampled.
+namespace PolylineLod {
+    // World units per pixel in the window's current view
+    double getPixelSize(const sf::RenderWindow& window);
+
+    // World rectangle the window's current view shows, widened by margin pixels on every side
+    ViewBounds getViewBounds(const sf::RenderWindow& window, float margin);
+
+    // Append the visible, simplified polyline to vertices as a line strip relative to origin.
+    // No dropped point is further than tolerance world units from the line that replaces it.
+    // Where the line leaves the view and comes back, the strip is bridged by a transparent
+    // segment, so vertices should hold nothing else or end where this strip may start.
+    void appendLineStrip(const std::vector<PolylinePoint>& points, const ViewBounds& bounds,
+        double tolerance, const Vector2d& origin, sf::VertexArray& vertices);
+}
\ No newline at end of file
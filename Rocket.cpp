@@ -1,6 +1,7 @@
 #include "Rocket.h"
 #include "VectorHelper.h"
 #include "GameConstants.h"
+#include "GravitySimulator.h"
 #include <cmath>
 
 Rocket::Rocket(sf::Vector2f pos, sf::Vector2f vel, sf::Color col, float m)
@@ -13,7 +14,7 @@ Rocket::Rocket(sf::Vector2f pos, sf::Vector2f vel, sf::Color col, float m)
     body.setPoint(2, { GameConstants::ROCKET_SIZE / 2, GameConstants::ROCKET_SIZE });
     body.setFillColor(color);
     body.setOrigin({ 0, 0 });
-    body.setPosition(position);
+    body.setPosition(getRenderPosition());
 
     // Add default engine
     addPart(std::make_unique<Engine>(sf::Vector2f(0, GameConstants::ROCKET_SIZE), GameConstants::ENGINE_THRUST_POWER));
@@ -32,10 +33,14 @@ void Rocket::applyThrust(float amount)
 
     // In SFML, 0 degrees points up, 90 degrees points right
     // So we need to use -sin for x and -cos for y to get the direction
-    sf::Vector2f thrustDir(std::sin(radians), -std::cos(radians));
+    Vector2d thrustDir(std::sin(radians), -std::cos(radians));
+
+    rest.wake();
+    thrustApplied = true;
+    trajectoryRevision++;
 
     // Apply force and convert to acceleration by dividing by mass (F=ma -> a=F/m)
-    velocity += thrustDir * amount * thrustLevel / mass;
+    velocity += thrustDir * static_cast<double>(amount * thrustLevel / mass);
 }
 
 void Rocket::rotate(float amount)
@@ -51,7 +56,7 @@ void Rocket::setThrustLevel(float level)
 
 bool Rocket::checkCollision(const Planet& planet)
 {
-    float dist = distance(position, planet.getPosition());
+    double dist = distance(position, planet.getWorldPosition());
     // Simple collision check based on distance
     return dist < planet.getRadius() + GameConstants::ROCKET_SIZE; // Use constant for rocket size // 15 = approximate rocket size
 }
@@ -64,18 +69,20 @@ bool Rocket::isColliding(const Planet& planet)
 Rocket* Rocket::mergeWith(Rocket* other)
 {
     // Create a new rocket with combined properties
-    sf::Vector2f mergedPosition = (position + other->getPosition()) / 2.0f;
+    Vector2d mergedPosition = (position + other->getWorldPosition()) / 2.0;
 
     // Conservation of momentum: (m1v1 + m2v2) / (m1 + m2)
-    sf::Vector2f mergedVelocity = (velocity * mass + other->getVelocity() * other->getMass())
-        / (mass + other->getMass());
+    Vector2d mergedVelocity = (velocity * static_cast<double>(mass) + other->getWorldVelocity() * static_cast<double>(other->getMass()))
+        / static_cast<double>(mass + other->getMass());
 
     // Use the color of the more massive rocket
     sf::Color mergedColor = (mass > other->getMass()) ? color : other->color;
 
     // Create a new rocket with combined mass
     float mergedMass = mass + other->getMass();
-    Rocket* mergedRocket = new Rocket(mergedPosition, mergedVelocity, mergedColor, mergedMass);
+    Rocket* mergedRocket = new Rocket(sf::Vector2f(mergedPosition), sf::Vector2f(mergedVelocity), mergedColor, mergedMass);
+    mergedRocket->setWorldPosition(mergedPosition);
+    mergedRocket->setWorldVelocity(mergedVelocity);
 
     // Combine thrust capabilities by adding an engine with combined thrust power
     float combinedThrust = 0.0f;
@@ -102,42 +109,63 @@ Rocket* Rocket::mergeWith(Rocket* other)
 
 void Rocket::update(float deltaTime)
 {
-    bool resting = false;
+    // GravitySimulator's integrator has already moved the rocket for this step;
+    // here we only resolve contact with planet surfaces.
+    // A sleeping rocket wasn't integrated and just rides along with its planet.
+    Vector2d carried = position;
+    bool asleep = rest.isSleeping() && rest.carry(carried, velocity, deltaTime);
+    if (asleep) {
+        advanceTo(carried);
+    }
 
     // Check if we're resting on any planet
+    const Planet* restingOn = nullptr;
     for (const auto& planet : nearbyPlanets) {
-        sf::Vector2f direction = position - planet->getPosition();
-        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        if (asleep) break;
+
+        Vector2d direction = position - planet->getWorldPosition();
+        double distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
 
         // If we're at or below the surface of the planet
         if (distance <= (planet->getRadius() + GameConstants::ROCKET_SIZE)) {
             // Calculate normal force direction (away from planet center)
-            sf::Vector2f normal = normalize(direction);
+            Vector2d normal = normalize(direction);
+
+            // Work in the planet's frame - a moon's surface moves with the moon
+            Vector2d surfaceVelocity = planet->getWorldVelocity();
+            Vector2d relativeVelocity = velocity - surfaceVelocity;
 
             // Project velocity onto normal to see if we're moving into the planet
-            float velDotNormal = velocity.x * normal.x + velocity.y * normal.y;
+            double velDotNormal = relativeVelocity.x * normal.x + relativeVelocity.y * normal.y;
 
             if (velDotNormal < 0) {
                 // Remove velocity component toward the planet
-                velocity -= normal * velDotNormal;
+                relativeVelocity -= normal * velDotNormal;
 
                 // Apply a small friction to velocity parallel to surface
-                sf::Vector2f tangent(-normal.y, normal.x);
-                float velDotTangent = velocity.x * tangent.x + velocity.y * tangent.y;
-                velocity = tangent * velDotTangent * 0.98f;
+                Vector2d tangent(-normal.y, normal.x);
+                double velDotTangent = relativeVelocity.x * tangent.x + relativeVelocity.y * tangent.y;
+                velocity = surfaceVelocity + tangent * velDotTangent * 0.98;
+                trajectoryRevision++;
 
                 // Position correction to stay exactly on surface
-                position = planet->getPosition() + normal * (planet->getRadius() + GameConstants::ROCKET_SIZE);
+                position = planet->getWorldPosition() + normal * static_cast<double>(planet->getRadius() + GameConstants::ROCKET_SIZE);
+            }
 
-                resting = true;
+            // At rest if it barely moves relative to the surface under it
+            Vector2d relative = velocity - planet->getWorldVelocity();
+            if (std::sqrt(relative.x * relative.x + relative.y * relative.y) < GameConstants::SLEEP_SPEED) {
+                restingOn = planet;
             }
         }
     }
 
-    // Only apply normal updates if not resting on a planet
-    if (!resting) {
-        position += velocity * deltaTime;
+    // Parked with no input for long enough: stop integrating until something wakes it
+    if (!asleep && rest.settle(restingOn != nullptr && !thrustApplied, deltaTime)) {
+        velocity = restingOn->getWorldVelocity();
+        rest.sleep(restingOn, position);
     }
+    thrustApplied = false;
 
     // Update rotation based on angular velocity
     rotation += angularVelocity * deltaTime;
@@ -145,26 +173,31 @@ void Rocket::update(float deltaTime)
     // Apply some damping to angular velocity
     angularVelocity *= 0.98f;
 
-    // Update body position and rotation
-    body.setPosition(position);
+    // Update body rotation; draw() places it at the interpolated position
     body.setRotation(sf::degrees(rotation));
 }
 
 void Rocket::draw(sf::RenderWindow& window)
 {
+    sf::Vector2f renderPosition = getRenderPosition();
+
     // Draw rocket body
+    body.setPosition(renderPosition);
     window.draw(body);
 
     // Draw all rocket parts
     for (const auto& part : parts) {
-        part->draw(window, position, rotation);
+        part->draw(window, renderPosition, rotation);
     }
 }
 
 void Rocket::drawWithConstantSize(sf::RenderWindow& window, float zoomLevel)
 {
+    sf::Vector2f renderPosition = getRenderPosition();
+
     // Store original position and scale
     sf::ConvexShape scaledBody = body;
+    scaledBody.setPosition(renderPosition);
 
     // Scale the body based on zoom level to maintain visual size
     float scaleMultiplier = zoomLevel;
@@ -181,7 +214,7 @@ void Rocket::drawWithConstantSize(sf::RenderWindow& window, float zoomLevel)
 
     // Draw rocket parts with appropriate scaling
     for (const auto& part : parts) {
-        part->draw(window, position, rotation, scaleMultiplier);
+        part->draw(window, renderPosition, rotation, scaleMultiplier);
     }
 }
 
@@ -190,53 +223,48 @@ void Rocket::drawVelocityVector(sf::RenderWindow& window, float scale)
     sf::VertexArray line(sf::PrimitiveType::LineStrip);
 
     sf::Vertex startVertex;
-    startVertex.position = position;
+    startVertex.position = getRenderPosition();
     startVertex.color = sf::Color::Yellow;
     line.append(startVertex);
 
     sf::Vertex endVertex;
-    endVertex.position = position + velocity * scale;
+    endVertex.position = startVertex.position + sf::Vector2f(velocity) * scale;
     endVertex.color = sf::Color::Red;
     line.append(endVertex);
 
     window.draw(line);
 }
 
-void Rocket::drawGravityForceVectors(sf::RenderWindow& window, const std::vector<Planet*>& planets, float scale)
+void Rocket::drawGravityForceVectors(sf::RenderWindow& window, GravitySimulator& simulator, float scale)
 {
-    // Gravitational constant - same as in GravitySimulator
-    const float G = GameConstants::G;  // Use the constant from the header
+    // Each planet's share of the pull at the rocket, from the simulator's shared query
+    const size_t planetCount = simulator.getPlanets().size();
+    std::vector<Vector2d> shares(planetCount);
+    Vector2d total;
+    simulator.accelerationsAt(&position, 1, simulator.getSimulationTime(), &total, shares.data());
 
     // Draw gravity force vector for each planet
-    for (const auto& planet : planets) {
-        // Calculate direction and distance
-        sf::Vector2f direction = planet->getPosition() - position;
-        float dist = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-        // Skip if we're inside the planet or too close
-        if (dist <= planet->getRadius() + 15.0f) {
+    for (const Vector2d& share : shares) {
+        // Planets we're inside or too close to contribute nothing
+        if (share.x == 0.0 && share.y == 0.0) {
             continue;
         }
 
-        // Calculate gravitational force
-        float forceMagnitude = G * planet->getMass() * mass / (dist * dist);
-        sf::Vector2f forceVector = normalize(direction) * forceMagnitude;
-
-        // Scale the force for visualization
-        forceVector *= scale / mass;
+        // Force / mass is the acceleration, scaled for visualization
+        sf::Vector2f forceVector(share * static_cast<double>(scale));
 
         // Create a vertex array for the force line
         sf::VertexArray forceLine(sf::PrimitiveType::LineStrip);
 
         // Start point (at rocket position)
         sf::Vertex startVertex;
-        startVertex.position = position;
+        startVertex.position = getRenderPosition();
         startVertex.color = sf::Color::Magenta; // Pink color
         forceLine.append(startVertex);
 
         // End point (force direction and magnitude)
         sf::Vertex endVertex;
-        endVertex.position = position + forceVector;
+        endVertex.position = startVertex.position + forceVector;
         endVertex.color = sf::Color(255, 20, 147); // Deep pink
         forceLine.append(endVertex);
 
@@ -245,166 +273,17 @@ void Rocket::drawGravityForceVectors(sf::RenderWindow& window, const std::vector
     }
 }
 
-void Rocket::drawTrajectory(sf::RenderWindow& window, const std::vector<Planet*>& planets,
+void Rocket::drawTrajectory(sf::RenderWindow& window, GravitySimulator& simulator,
     float timeStep, int steps, bool detectSelfIntersection) {
+    // Bring the cached path up to date - usually just dropping passed samples and adding a new one
+    trajectoryCache.update(simulator.getEphemeris(), simulator.getSimulationTime(), position, velocity,
+        trajectoryRevision, timeStep, steps, simulator.getPatchedConics());
+
     // Create a vertex array for the trajectory line
     sf::VertexArray trajectory(sf::PrimitiveType::LineStrip);
-
-    // Start with current position and velocity
-    sf::Vector2f simPosition = position;
-    sf::Vector2f simVelocity = velocity;
-
-    // Add the starting point
-    sf::Vertex startPoint;
-    startPoint.position = simPosition;
-    startPoint.color = sf::Color::Blue; // Blue at the beginning
-    trajectory.append(startPoint);
-
-    // Store previous positions
-    std::vector<sf::Vector2f> previousPositions;
-    previousPositions.push_back(simPosition);
-
-    // Use the same gravitational constant as defined in GameConstants
-    const float G = GameConstants::G;
-    const float selfIntersectionThreshold = GameConstants::TRAJECTORY_COLLISION_RADIUS;
-
-    // Create simulated planet positions and velocities
-    std::vector<sf::Vector2f> simPlanetPositions;
-    std::vector<sf::Vector2f> simPlanetVelocities;
-
-    // Initialize simulated planet data
-    for (const auto& planet : planets) {
-        simPlanetPositions.push_back(planet->getPosition());
-        simPlanetVelocities.push_back(planet->getVelocity());
-    }
-
-    // Simulate future positions using more accurate physics
-    for (int i = 0; i < steps; i++) {
-        // Update simulated planet positions
-        for (size_t j = 0; j < planets.size(); j++) {
-            simPlanetPositions[j] += simPlanetVelocities[j] * timeStep;
-        }
-
-        // Calculate gravitational interactions between planets
-        for (size_t j = 0; j < planets.size(); j++) {
-            // Skip the first planet (index 0) if it's pinned in place
-            if (j == 0) continue;
-
-            sf::Vector2f totalPlanetAcceleration(0, 0);
-
-            // Calculate gravity from other planets
-            for (size_t k = 0; k < planets.size(); k++) {
-                if (j == k) continue; // Skip self
-
-                sf::Vector2f direction = simPlanetPositions[k] - simPlanetPositions[j];
-                float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                if (distance > planets[k]->getRadius() + planets[j]->getRadius()) {
-                    float forceMagnitude = G * planets[k]->getMass() * planets[j]->getMass() / (distance * distance);
-                    sf::Vector2f acceleration = normalize(direction) * forceMagnitude / planets[j]->getMass();
-                    totalPlanetAcceleration += acceleration;
-                }
-            }
-
-            // Update planet velocity
-            simPlanetVelocities[j] += totalPlanetAcceleration * timeStep;
-        }
-
-        // Calculate gravitational forces from all planets
-        sf::Vector2f totalAcceleration(0, 0);
-        bool collisionDetected = false;
-
-        // Calculate gravitational interactions between planets and rocket
-        for (size_t j = 0; j < planets.size(); j++) {
-            const auto& planet = planets[j];
-            sf::Vector2f planetPos = simPlanetPositions[j];
-
-            sf::Vector2f direction = planetPos - simPosition;
-            float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-            // Check for planet collision using consistent collision radius
-            if (distance <= planet->getRadius() + GameConstants::TRAJECTORY_COLLISION_RADIUS) {
-                collisionDetected = true;
-                break;
-            }
-
-            // Calculate gravitational force with proper inverse square law
-            // F = G * (m1 * m2) / r^2
-            float forceMagnitude = G * planet->getMass() * mass / (distance * distance);
-
-            // Convert force to acceleration (a = F/m)
-            sf::Vector2f acceleration = normalize(direction) * forceMagnitude / mass;
-            totalAcceleration += acceleration;
-        }
-
-        // Stop if we hit a planet
-        if (collisionDetected) {
-            break;
-        }
-
-        // Use velocity Verlet integration for better numerical stability
-        sf::Vector2f halfStepVelocity = simVelocity + totalAcceleration * (timeStep * 0.5f);
-        simPosition += halfStepVelocity * timeStep;
-
-        // Recalculate acceleration at new position for higher accuracy
-        sf::Vector2f newAcceleration(0, 0);
-
-        for (size_t j = 0; j < planets.size(); j++) {
-            const auto& planet = planets[j];
-            sf::Vector2f planetPos = simPlanetPositions[j];
-
-            sf::Vector2f direction = planetPos - simPosition;
-            float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-            if (distance <= planet->getRadius() + GameConstants::TRAJECTORY_COLLISION_RADIUS) {
-                collisionDetected = true;
-                break;
-            }
-
-            float forceMagnitude = G * planet->getMass() * mass / (distance * distance);
-            sf::Vector2f acceleration = normalize(direction) * forceMagnitude / mass;
-            newAcceleration += acceleration;
-        }
-
-        if (collisionDetected) {
-            break;
-        }
-
-        // Complete the velocity update with the new acceleration
-        simVelocity = halfStepVelocity + newAcceleration * (timeStep * 0.5f);
-
-        // Self-intersection check if enabled
-        if (detectSelfIntersection) {
-            for (size_t j = 0; j < previousPositions.size() - 10; j++) {
-                float distToPoint = distance(simPosition, previousPositions[j]);
-                if (distToPoint < selfIntersectionThreshold) {
-                    collisionDetected = true;
-                    break;
-                }
-            }
-
-            if (collisionDetected) {
-                break;
-            }
-        }
-
-        // Store this position for future self-intersection checks
-        previousPositions.push_back(simPosition);
-
-        // Calculate color gradient from blue to pink
-        float ratio = static_cast<float>(i) / steps;
-        sf::Color pointColor(
-            51 + 204 * ratio,  // R: 51 (blue) to 255 (pink)
-            51 + 0 * ratio,    // G: 51 (blue) to 51 (pink)
-            255 - 155 * ratio  // B: 255 (blue) to 100 (pink)
-        );
-
-        // Add point to trajectory
-        sf::Vertex point;
-        point.position = simPosition;
-        point.color = pointColor;
-        trajectory.append(point);
-    }
+    trajectoryCache.buildVertices(simulator.getEphemeris(), trajectory, position, getRenderOrigin(), steps,
+        detectSelfIntersection, PolylineLod::getPixelSize(window),
+        PolylineLod::getViewBounds(window, GameConstants::POLYLINE_LOD_MARGIN));
 
     // Draw the trajectory
     window.draw(trajectory);
@@ -4,9 +4,13 @@
 #include "RocketPart.h"
 #include "Engine.h"
 #include "Planet.h"
+#include "SurfaceRest.h"
+#include "TrajectoryCache.h"
 #include <vector>
 #include <memory>
 
+class GravitySimulator;
+
 class Rocket : public GameObject {
 private:
     sf::ConvexShape body;
@@ -16,6 +20,10 @@ private:
     float thrustLevel; // Current thrust level (0.0 to 1.0)
     std::vector<Planet*> nearbyPlanets;
     float mass; // Added mass property for physics calculations
+    SurfaceRest rest;
+    bool thrustApplied = false; // applyThrust was called since the last update
+    TrajectoryCache trajectoryCache;
+    unsigned long long trajectoryRevision = 0;  // Bumped whenever thrust or a collision changes the coasting path
 
     bool checkCollision(const Planet& planet);
 
@@ -27,8 +35,13 @@ public:
     void rotate(float amount);
     void setThrustLevel(float level); // Set thrust level between 0.0 and 1.0
     bool isColliding(const Planet& planet);
+
+    // Parked on a planet: skipped by the gravity simulator and carried along with the planet.
+    // Thrust or any outside change to the rocket's state wakes it.
+    bool isSleeping() const { return rest.isSleeping(); }
+    void wake() { rest.wake(); }
     void setNearbyPlanets(const std::vector<Planet*>& planets) { nearbyPlanets = planets; }
-    void setPosition(sf::Vector2f pos) { position = pos; }
+    void setPosition(sf::Vector2f pos) { setWorldPosition(Vector2d(pos)); }
     Rocket* mergeWith(Rocket* other);
 
     // Add getter for mass
@@ -42,10 +55,14 @@ public:
     void drawVelocityVector(sf::RenderWindow& window, float scale = GameConstants::VELOCITY_VECTOR_SCALE);
 
     // New method to draw gravity force vectors
-    void drawGravityForceVectors(sf::RenderWindow& window, const std::vector<Planet*>& planets, float scale = 1.0f);
+    void drawGravityForceVectors(sf::RenderWindow& window, GravitySimulator& simulator, float scale = 1.0f);
 
-    void drawTrajectory(sf::RenderWindow& window, const std::vector<Planet*>& planets,
-        float timeStep = 0.5f, int steps = 200, bool detectSelfIntersection = false);
+    // Predicted path from the rocket's current state, with planet gravity from the simulator.
+    // The path is cached and only extended while the rocket coasts.
+    void drawTrajectory(sf::RenderWindow& window, GravitySimulator& simulator,
+        float timeStep = 0.5f, int steps = 200, bool detectSelfIntersection = true);
+    const TrajectoryCache& getTrajectoryCache() const { return trajectoryCache; }
+    unsigned long long getTrajectoryRevision() const { return trajectoryRevision; }
     float getThrustLevel() const { return thrustLevel; }
     const std::vector<std::unique_ptr<RocketPart>>& getParts() const { return parts; }
     float getRotation() const { return rotation; }
@@ -0,0 +1,44 @@
+// SimulationClock.cpp
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock(float tickRate, int maxSubsteps)
+    : fixedDeltaTime(1.0f / tickRate), maxSubsteps(maxSubsteps > 0 ? maxSubsteps : 1),
+    accumulator(0.0f), alpha(0.0f), droppedTime(0.0f), tickCount(0)
+{
+}
+
+int SimulationClock::advance(float frameTime)
+{
+    if (frameTime > 0.0f) {
+        accumulator += frameTime;
+    }
+
+    int steps = static_cast<int>(accumulator / fixedDeltaTime);
+    accumulator -= steps * fixedDeltaTime;
+
+    // Spiral-of-death guard: run at most maxSubsteps and let the game slow down
+    // instead of trying to catch up on the backlog
+    if (steps > maxSubsteps) {
+        droppedTime += (steps - maxSubsteps) * fixedDeltaTime;
+        steps = maxSubsteps;
+    }
+
+    tickCount += steps;
+    alpha = accumulator / fixedDeltaTime;
+    return steps;
+}
+
+void SimulationClock::reset()
+{
+    accumulator = 0.0f;
+    alpha = 0.0f;
+    droppedTime = 0.0f;
+    tickCount = 0;
+}
+
+void SimulationClock::setTickRate(float tickRate)
+{
+    if (tickRate > 0.0f) {
+        fixedDeltaTime = 1.0f / tickRate;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+// SimulationClock.h
+#pragma once
+#include "GameConstants.h"
+
+// Turns variable frame times into a whole number of fixed simulation steps.
+// Leftover time stays in an accumulator and is exposed as an interpolation
+// factor so rendering can blend between the last two steps.
+class SimulationClock {
+private:
+    float fixedDeltaTime;
+    int maxSubsteps;
+    float accumulator;
+    float alpha;
+    float droppedTime;          // Real time discarded by the substep limit
+    unsigned long tickCount;
+
+public:
+    SimulationClock(float tickRate = GameConstants::SIMULATION_TICK_RATE,
+        int maxSubsteps = GameConstants::MAX_SIMULATION_SUBSTEPS);
+
+    // Add one frame of real time and return how many fixed steps to run
+    int advance(float frameTime);
+    void reset();
+
+    void setTickRate(float tickRate);
+    float getTickRate() const { return 1.0f / fixedDeltaTime; }
+    float getFixedDeltaTime() const { return fixedDeltaTime; }
+
+    // Upper bound on steps per frame, so a slow frame can't trigger ever slower frames
+    void setMaxSubsteps(int steps) { maxSubsteps = steps > 0 ? steps : 1; }
+    int getMaxSubsteps() const { return maxSubsteps; }
+
+    // Fraction of a step left in the accumulator (0..1), for render interpolation
+    float getAlpha() const { return alpha; }
+    float getDroppedTime() const { return droppedTime; }
+    unsigned long getTickCount() const { return tickCount; }
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+// SpatialHashGrid.cpp
+#include "SpatialHashGrid.h"
+#include <limits>
+
+std::uint64_t SpatialHashGrid::makeKey(std::int64_t cellX, std::int64_t cellY)
+{
+    // Cell coordinates are clamped to 32 bits by toCell, so packing them is exact
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cellX)) << 32) |
+        static_cast<std::uint32_t>(cellY);
+}
+
+std::int64_t SpatialHashGrid::toCell(double coordinate) const
+{
+    const double limit = static_cast<double>(std::numeric_limits<std::int32_t>::max());
+    double cell = std::floor(coordinate / cellSize);
+    return static_cast<std::int64_t>(std::max(-limit, std::min(limit, cell)));
+}
+
+const SpatialHashGrid::Cell* SpatialHashGrid::findCell(std::uint64_t key) const
+{
+    auto it = std::lower_bound(cells.begin(), cells.end(), key,
+        [](const Cell& cell, std::uint64_t value) { return cell.key < value; });
+    return (it != cells.end() && it->key == key) ? &*it : nullptr;
+}
+
+void SpatialHashGrid::build(const double* bodyX, const double* bodyY, size_t count, double size)
+{
+    cellSize = size > 0.0 ? size : 1.0;
+
+    bodyKeys.resize(count);
+    bodies.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        bodyKeys[i] = makeKey(toCell(bodyX[i]), toCell(bodyY[i]));
+        bodies[i] = static_cast<int>(i);
+    }
+
+    // Group bodies by cell, then record each run as one cell
+    std::sort(bodies.begin(), bodies.end(),
+        [this](int a, int b) { return bodyKeys[a] < bodyKeys[b]; });
+
+    cells.clear();
+    for (size_t i = 0; i < count; i++) {
+        std::uint64_t key = bodyKeys[bodies[i]];
+        if (cells.empty() || cells.back().key != key) {
+            cells.push_back({ key, i, i });
+        }
+        cells.back().end = i + 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+// SpatialHashGrid.h
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid broadphase: bodies are bucketed by square cell, and a neighbourhood query
+// only visits the cells overlapping the query radius. Only occupied cells are stored, so
+// the grid is unbounded and costs O(n log n) to build however spread out the bodies are.
+class SpatialHashGrid {
+private:
+    struct Cell {
+        std::uint64_t key;
+        size_t begin;               // Range of this cell's bodies in 'bodies'
+        size_t end;
+    };
+
+    double cellSize = 1.0;
+    std::vector<Cell> cells;        // Sorted by key
+    std::vector<int> bodies;        // Body indices grouped by cell
+    std::vector<std::uint64_t> bodyKeys;
+
+    static std::uint64_t makeKey(std::int64_t cellX, std::int64_t cellY);
+    std::int64_t toCell(double coordinate) const;
+    const Cell* findCell(std::uint64_t key) const;
+
+public:
+    // Rebuild from scratch for the given positions; queries are cheapest when the cell
+    // size is about the largest radius they ask for
+    void build(const double* bodyX, const double* bodyY, size_t count, double size);
+
+    // Call visit(body) for every body in the cells overlapping the circle. This is a
+    // superset: callers still check the exact distance.
+    template <typename Visitor>
+    void forEachNear(double x, double y, double radius, Visitor visit) const;
+
+    double getCellSize() const { return cellSize; }
+    size_t getCellCount() const { return cells.size(); }
+};
+
+template <typename Visitor>
+void SpatialHashGrid::forEachNear(double x, double y, double radius, Visitor visit) const
+{
+    const std::int64_t minX = toCell(x - radius);
+    const std::int64_t maxX = toCell(x + radius);
+    const std::int64_t minY = toCell(y - radius);
+    const std::int64_t maxY = toCell(y + radius);
+
+    for (std::int64_t cx = minX; cx <= maxX; cx++) {
+        for (std::int64_t cy = minY; cy <= maxY; cy++) {
+            const Cell* cell = findCell(makeKey(cx, cy));
+            if (!cell) continue;
+            for (size_t i = cell->begin; i < cell->end; i++) {
+                visit(bodies[i]);
+            }
+        }
+    }
+}
\ No newline at end of file
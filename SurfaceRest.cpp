@@ -0,0 +1,61 @@
+// SurfaceRest.cpp
+#include "SurfaceRest.h"
+#include "GameConstants.h"
+#include <cmath>
+
+bool SurfaceRest::settle(bool atRest, float deltaTime)
+{
+    restTime = atRest ? restTime + deltaTime : 0.0f;
+    return restTime >= GameConstants::SLEEP_DELAY;
+}
+
+void SurfaceRest::sleep(const Planet* restingOn, const Vector2d& position)
+{
+    planet = restingOn;
+    offset = position - planet->getWorldPosition();
+    carriedPosition = position;
+    carriedVelocity = planet->getWorldVelocity();
+    planetVelocity = planet->getWorldVelocity();
+    accelerationKnown = false;
+}
+
+void SurfaceRest::wake()
+{
+    planet = nullptr;
+    restTime = 0.0f;
+}
+
+bool SurfaceRest::carry(Vector2d& position, Vector2d& velocity, float deltaTime)
+{
+    // A network correction, a teleport or a collision response moved the body
+    if (position != carriedPosition || velocity != carriedVelocity) {
+        wake();
+        return false;
+    }
+
+    // The planet's acceleration is what held the body against the surface in its frame.
+    // A change comparable to surface gravity could lift it, so hand it back to the integrator.
+    const Vector2d& newVelocity = planet->getWorldVelocity();
+    if (deltaTime > 0.0f) {
+        Vector2d acceleration = (newVelocity - planetVelocity) / static_cast<double>(deltaTime);
+        if (!accelerationKnown) {
+            sleepAcceleration = acceleration;
+            accelerationKnown = true;
+        }
+        double radius = planet->getRadius();
+        double surfaceGravity = GameConstants::G * planet->getMass() / (radius * radius);
+        Vector2d change = acceleration - sleepAcceleration;
+        if (std::sqrt(change.x * change.x + change.y * change.y) >
+            GameConstants::SLEEP_WAKE_ACCELERATION * surfaceGravity) {
+            wake();
+            return false;
+        }
+    }
+    planetVelocity = newVelocity;
+
+    position = planet->getWorldPosition() + offset;
+    velocity = newVelocity;
+    carriedPosition = position;
+    carriedVelocity = velocity;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+// SurfaceRest.h
+#pragma once
+#include "Planet.h"
+#include "VectorHelper.h"
+
+// Sleep state for a body parked on a planet. While asleep the body is carried rigidly with
+// its planet instead of being integrated, and the gravity passes leave it out entirely.
+class SurfaceRest {
+private:
+    const Planet* planet = nullptr;     // Planet slept on, or null while awake
+    Vector2d offset;                    // Body position relative to the planet centre
+    Vector2d carriedPosition;           // State written by the last carry; any change wakes the body
+    Vector2d carriedVelocity;
+    Vector2d planetVelocity;            // Planet velocity at the last carry, to measure its acceleration
+    Vector2d sleepAcceleration;         // Planet acceleration when the body fell asleep
+    bool accelerationKnown = false;
+    float restTime = 0.0f;              // Seconds spent at rest while awake
+
+public:
+    bool isSleeping() const { return planet != nullptr; }
+    const Planet* getPlanet() const { return planet; }
+
+    // Count time at rest on a planet; true once the body has rested long enough to sleep
+    bool settle(bool atRest, float deltaTime);
+    void sleep(const Planet* restingOn, const Vector2d& position);
+    void wake();
+
+    // Move the body along with its planet. Wakes it and returns false instead if the body
+    // was moved by something else, or the planet's acceleration changed enough to lift it.
+    bool carry(Vector2d& position, Vector2d& velocity, float deltaTime);
+};
\ No newline at end of file
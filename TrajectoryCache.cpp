@@ -0,0 +1,367 @@
+// TrajectoryCache.cpp
+#include "TrajectoryCache.h"
+#include "GameConstants.h"
+#include "GravitySimulator.h"
+#include "PlanetEphemeris.h"
+#include "PolylineLod.h"
+#include "SpatialHashGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double FULL_TURN = 6.283185307179586;
+}
+
+std::atomic<TrajectoryMethod> TrajectoryCache::activeMethod{ TrajectoryMethod::DORMAND_PRINCE };
+
+Vector2d TrajectoryCache::interpolate(double time) const
+{
+    return interpolate(0, time);
+}
+
+Vector2d TrajectoryCache::interpolate(size_t segment, double time) const
+{
+    const TrajectorySample& a = samples[segment];
+    const TrajectorySample& b = samples[segment + 1];
+    const double h = b.time - a.time;
+    const double u = (time - a.time) / h;
+
+    // Adaptive steps are long, so they use the accelerations too
+    if (isAdaptive()) {
+        return DormandPrince::positionAt({ a.position, a.velocity }, a.acceleration,
+            { b.position, b.velocity }, b.acceleration, h, u);
+    }
+
+    // Cubic Hermite from the positions and velocities at both ends
+    double u2 = u * u;
+    double u3 = u2 * u;
+    double h00 = 2.0 * u3 - 3.0 * u2 + 1.0;
+    double h10 = (u3 - 2.0 * u2 + u) * h;
+    double h01 = -2.0 * u3 + 3.0 * u2;
+    double h11 = (u3 - u2) * h;
+    return a.position * h00 + a.velocity * h10 + b.position * h01 + b.velocity * h11;
+}
+
+bool TrajectoryCache::accelerationAt(PlanetEphemeris& table, const Vector2d& position, double time, Vector2d& acceleration)
+{
+    forceEvaluations++;
+    return GravitySimulator::accelerationsAt(table, planetScratch, &position, 1, time, &acceleration);
+}
+
+bool TrajectoryCache::startPath(PlanetEphemeris& table, TrajectorySample& start)
+{
+    // The planet pulling hardest is the one this path orbits, if it orbits anything
+    forceEvaluations++;
+    planetPull.resize(table.getPlanetCount());
+    bool inside = GravitySimulator::accelerationsAt(table, planetScratch, &start.position, 1, start.time,
+        &start.acceleration, planetPull.data());
+    primaryPlanet = -1;
+    double strongest = 0.0;
+    for (size_t j = 0; j < planetPull.size(); j++) {
+        double pull = planetPull[j].x * planetPull[j].x + planetPull[j].y * planetPull[j].y;
+        if (pull > strongest) {
+            strongest = pull;
+            primaryPlanet = static_cast<int>(j);
+        }
+    }
+    start.sweep = 0.0;
+    return inside;
+}
+
+double TrajectoryCache::sweepTo(PlanetEphemeris& table, const TrajectorySample& from, double time, const Vector2d& position)
+{
+    if (primaryPlanet < 0) {
+        return 0.0;
+    }
+
+    // Signed angle between the offsets from the planet, wherever it was at each time
+    Vector2d before = from.position - table.positionAt(primaryPlanet, from.time);
+    Vector2d after = position - table.positionAt(primaryPlanet, time);
+    double cross = before.x * after.y - before.y * after.x;
+    double dot = before.x * after.x + before.y * after.y;
+    return from.sweep + std::atan2(cross, dot);
+}
+
+bool TrajectoryCache::isClosed() const
+{
+    return !samples.empty() && std::abs(samples.back().sweep - samples.front().sweep) >= FULL_TURN;
+}
+
+bool TrajectoryCache::endsAtPlanet() const
+{
+    return onConic && !conic.needsContinuation() ? conic.endsAtPlanet() : hitPlanet;
+}
+
+void TrajectoryCache::extend(PlanetEphemeris& table)
+{
+    const TrajectorySample last = samples.back();
+    Vector2d position = last.position;
+    Vector2d velocity = last.velocity;
+    double stageTime = last.time;
+
+    // Only the rocket is integrated; planet gravity comes from the simulator at each stage's time
+    auto kick = [&](float dt) {
+        // Stop at the first planet the path runs into
+        Vector2d acceleration;
+        if (accelerationAt(table, position, stageTime, acceleration)) {
+            hitPlanet = true;
+        }
+        velocity += acceleration * static_cast<double>(dt);
+    };
+    auto drift = [&](float dt) {
+        position += velocity * static_cast<double>(dt);
+        stageTime += dt;
+    };
+    Integrator::stepWith(integrator, timeStep, kick, drift);
+    integratedSteps++;
+
+    if (!hitPlanet) {
+        // Exact step time, so rounding in the stage times doesn't accumulate along the path
+        double time = last.time + timeStep;
+        samples.push_back({ time, position, velocity, Vector2d(), sweepTo(table, last, time, position) });
+    }
+}
+
+void TrajectoryCache::extendAdaptive(PlanetEphemeris& table)
+{
+    const TrajectorySample last = samples.back();
+    const DormandPrince::State start = { last.position, last.velocity };
+    auto accelerate = [&](const Vector2d& position, double time, Vector2d& acceleration) {
+        return accelerationAt(table, position, time, acceleration);
+    };
+
+    // The fixed step is the finest resolution the caller asked for; a step that reaches a
+    // planet is halved down to it before the path is ended there
+    const double minimumStep = timeStep;
+    while (true) {
+        double h = std::max(minimumStep, std::min(adaptiveStep, static_cast<double>(GameConstants::TRAJECTORY_MAX_STEP)));
+        DormandPrince::State end;
+        DormandPrince::State error;
+        Vector2d endAcceleration;
+        integratedSteps++;
+        if (!DormandPrince::step(accelerate, last.time, h, start, last.acceleration, end, endAcceleration, error)) {
+            if (h <= minimumStep) {
+                hitPlanet = true;
+                return;
+            }
+            adaptiveStep = h * 0.5;
+            continue;
+        }
+
+        double ratio = DormandPrince::errorRatio(error, GameConstants::TRAJECTORY_POSITION_TOLERANCE,
+            GameConstants::TRAJECTORY_VELOCITY_TOLERANCE);
+        adaptiveStep = DormandPrince::nextStepSize(h, ratio);
+        if (ratio <= 1.0 || h <= minimumStep) {
+            samples.push_back({ last.time + h, end.position, end.velocity, endAcceleration,
+                sweepTo(table, last, last.time + h, end.position) });
+            return;
+        }
+    }
+}
+
+void TrajectoryCache::update(PlanetEphemeris& table, double now, const Vector2d& position, const Vector2d& velocity,
+    unsigned long long revision, float step, int steps, bool patchedConics)
+{
+    const IntegratorType type = Integrator::getActiveType();
+    const TrajectoryMethod currentMethod = getActiveMethod();
+    const double horizon = now + static_cast<double>(step) * steps;
+    pathStart = now;
+
+    // Follow the conic while one planet dominates, and integrate only from where it ends
+    double start = now;
+    Vector2d startPosition = position;
+    Vector2d startVelocity = velocity;
+    onConic = patchedConics && conic.fit(table, now, position, velocity, horizon);
+    if (onConic) {
+        if (!conic.needsContinuation()) {
+            samples.clear();
+            valid = false;
+            return;
+        }
+        start = conic.getEndTime();
+        conic.getEndState(table, startPosition, startVelocity);
+    }
+
+    if (table.getRevision() != ephemerisRevision || revision != pathRevision || type != integrator ||
+        step != timeStep || currentMethod != method) {
+        valid = false;
+    }
+
+    if (valid) {
+        // Consume the samples the simulation has passed, keeping one at or before the start
+        while (samples.size() >= 2 && samples[1].time <= start) {
+            samples.pop_front();
+        }
+
+        // Anything that moved the rocket without a new path revision - a network
+        // correction, a teleport, or just integration error building up - shows as a gap.
+        // The end of a conic moves back and forth a little, so it may start just before the path.
+        if (samples.size() < 2 || samples.front().time - start > 0.5 * timeStep) {
+            valid = false;
+        }
+        else {
+            Vector2d gap = interpolate(start) - startPosition;
+            if (std::sqrt(gap.x * gap.x + gap.y * gap.y) > GameConstants::TRAJECTORY_CACHE_TOLERANCE) {
+                valid = false;
+            }
+        }
+    }
+
+    if (!valid) {
+        samples.clear();
+        samples.push_back({ start, startPosition, startVelocity, Vector2d(), 0.0 });
+        hitPlanet = startPath(table, samples.front());
+        timeStep = step;
+        integrator = type;
+        method = currentMethod;
+        ephemerisRevision = table.getRevision();
+        pathRevision = revision;
+        valid = true;
+        rebuilds++;
+
+        // Start adaptive steps at the fixed step and let the error estimate grow them
+        adaptiveStep = step;
+    }
+
+    if (isAdaptive()) {
+        // Keep the path as far ahead in time as steps fixed steps would reach
+        while (!hitPlanet && !isClosed() && samples.back().time < horizon) {
+            extendAdaptive(table);
+        }
+        return;
+    }
+
+    // Keep the path steps steps ahead of now, counting any conic in front of the samples
+    while (!hitPlanet && !isClosed() && samples.back().time + 0.5 * timeStep < horizon) {
+        extend(table);
+    }
+}
+
+void TrajectoryCache::buildVertices(PlanetEphemeris& table, sf::VertexArray& vertices, const Vector2d& start,
+    const Vector2d& origin, int steps, bool detectSelfIntersection, double pixelSize, const ViewBounds& bounds) const
+{
+    vertices.setPrimitiveType(sf::PrimitiveType::LineStrip);
+    vertices.clear();
+
+    // Points along the path in world space, each with its fraction of the way to the horizon
+    std::vector<std::pair<Vector2d, float>> points;
+    const double span = static_cast<double>(timeStep) * steps;
+    if (onConic) {
+        conic.tessellate(table, GameConstants::TRAJECTORY_CONIC_TOLERANCE * pixelSize, pathStart, span, points);
+    }
+    // Unless the conic is the whole path, the integrated samples carry on from its end
+    const bool continued = !onConic || conic.needsContinuation();
+    if (continued && isAdaptive() && samples.size() >= 2) {
+        double spacing = GameConstants::TRAJECTORY_VERTEX_SPACING * pixelSize;
+
+        // Measure the path first, so zooming right in can't produce an unbounded vertex count
+        double length = 0.0;
+        for (size_t i = 1; i < samples.size(); i++) {
+            length += distance(samples[i - 1].position, samples[i].position);
+        }
+        spacing = std::max(spacing, length / GameConstants::TRAJECTORY_MAX_VERTICES);
+
+        for (size_t i = 1; i < samples.size(); i++) {
+            const TrajectorySample& a = samples[i - 1];
+            const TrajectorySample& b = samples[i];
+
+            // The chord underestimates a curved segment, so take the average speed instead
+            double speedA = std::sqrt(a.velocity.x * a.velocity.x + a.velocity.y * a.velocity.y);
+            double speedB = std::sqrt(b.velocity.x * b.velocity.x + b.velocity.y * b.velocity.y);
+            double segmentLength = 0.5 * (speedA + speedB) * (b.time - a.time);
+            int pieces = std::max(1, static_cast<int>(std::ceil(segmentLength / spacing)));
+            for (int k = 1; k <= pieces; k++) {
+                double time = a.time + (b.time - a.time) * k / pieces;
+                points.push_back({ k == pieces ? b.position : interpolate(i - 1, time),
+                    static_cast<float>((time - pathStart) / span) });
+            }
+        }
+    }
+    else if (continued) {
+        // The first sample is at or behind the current time and is replaced by the rocket itself
+        for (size_t i = 1; i < samples.size(); i++) {
+            points.push_back({ samples[i].position, static_cast<float>((samples[i].time - pathStart) / span) });
+        }
+    }
+
+    // Add the starting point
+    std::vector<PolylinePoint> polyline;
+    polyline.reserve(points.size() + 1);
+    polyline.push_back({ start, sf::Color::Blue }); // Blue at the beginning
+
+    const float selfIntersectionThreshold = GameConstants::TRAJECTORY_COLLISION_RADIUS;
+
+    // Bucket the points by cell, so each one is only checked against its neighbours. Points
+    // are told apart by the path length between them, not their count, which depends on the
+    // zoom and the rocket's speed.
+    SpatialHashGrid grid;
+    std::vector<double> arcLength;
+    const double skippedLength = GameConstants::TRAJECTORY_SELF_INTERSECTION_SKIP * selfIntersectionThreshold;
+    if (detectSelfIntersection) {
+        std::vector<double> pointX(points.size());
+        std::vector<double> pointY(points.size());
+        arcLength.resize(points.size());
+        Vector2d previous = start;
+        double length = 0.0;
+        for (size_t i = 0; i < points.size(); i++) {
+            pointX[i] = points[i].first.x;
+            pointY[i] = points[i].first.y;
+            length += distance(previous, points[i].first);
+            arcLength[i] = length;
+            previous = points[i].first;
+        }
+        grid.build(pointX.data(), pointY.data(), points.size(), selfIntersectionThreshold);
+    }
+
+    for (size_t i = 0; i < points.size(); i++) {
+        const Vector2d& simPosition = points[i].first;
+
+        // Self-intersection check if enabled, ignoring the stretch of path just behind this point
+        if (detectSelfIntersection) {
+            bool collisionDetected = false;
+            grid.forEachNear(simPosition.x, simPosition.y, selfIntersectionThreshold, [&](int j) {
+                if (static_cast<size_t>(j) < i && arcLength[i] - arcLength[j] > skippedLength &&
+                    distance(simPosition, points[j].first) < selfIntersectionThreshold) {
+                    collisionDetected = true;
+                }
+            });
+
+            if (collisionDetected) {
+                break;
+            }
+        }
+
+        // Calculate color gradient from blue to pink
+        float ratio = points[i].second;
+        sf::Color pointColor(
+            51 + 204 * ratio,  // R: 51 (blue) to 255 (pink)
+            51 + 0 * ratio,    // G: 51 (blue) to 51 (pink)
+            255 - 155 * ratio  // B: 255 (blue) to 100 (pink)
+        );
+
+        // Add point to trajectory
+        polyline.push_back({ simPosition, pointColor });
+    }
+
+    // Only what the view shows, with no more vertices than the pixels need
+    PolylineLod::appendLineStrip(polyline, bounds, GameConstants::POLYLINE_LOD_TOLERANCE * pixelSize, origin, vertices);
+}
+
+TrajectoryMethod TrajectoryCache::getActiveMethod()
+{
+    return activeMethod.load(std::memory_order_relaxed);
+}
+
+void TrajectoryCache::setActiveMethod(TrajectoryMethod type)
+{
+    activeMethod.store(type, std::memory_order_relaxed);
+}
+
+const char* TrajectoryCache::getName(TrajectoryMethod type)
+{
+    switch (type) {
+    case TrajectoryMethod::DORMAND_PRINCE: return "Dormand-Prince";
+    case TrajectoryMethod::FIXED_STEP:
+    default: return "Fixed step";
+    }
+}
\ No newline at end of file
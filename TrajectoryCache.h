@@ -0,0 +1,114 @@
+// TrajectoryCache.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "BodyStore.h"
+#include "ConicTrajectory.h"
+#include "DormandPrince.h"
+#include "Integrator.h"
+#include "PolylineLod.h"
+#include "VectorHelper.h"
+#include <atomic>
+#include <deque>
+#include <vector>
+
+class PlanetEphemeris;
+
+// Predicted state at an absolute simulation time
+struct TrajectorySample {
+    double time;
+    Vector2d position;
+    Vector2d velocity;
+    Vector2d acceleration;  // Only kept by adaptive prediction, for dense output
+    double sweep;           // Angle turned about the primary planet since the path was rebuilt
+};
+
+// How the path is integrated
+enum class TrajectoryMethod {
+    FIXED_STEP,     // The active integrator at the requested step, as the simulation would
+    DORMAND_PRINCE  // Adaptive steps under error control, sampled between steps for drawing
+};
+
+// A rocket's predicted path, kept between frames. As simulation time passes, samples are
+// dropped from the front and new ones integrated onto the back, so a coasting rocket costs
+// a step or so per frame instead of the whole horizon. The path is recomputed from scratch
+// when the rocket's path revision changes (thrust or a collision), when the planets change
+// (the ephemeris was rebuilt), when the integrator or step changes, or when the rocket has
+// strayed from it.
+//
+// With adaptive prediction the samples are the ends of variable Dormand-Prince steps: long
+// on slow coasting arcs, short through periapsis. The path covers the same span of time as
+// steps fixed steps would, and vertices are placed along it by distance rather than one per
+// step.
+//
+// When the simulation moves coasting rockets on patched conics, the path starts as the
+// rocket's Kepler orbit around the planet whose sphere of influence it is in. Only if that
+// orbit leaves the sphere is the rest integrated, from the conic's end, so the samples then
+// start in the future.
+//
+// Either way the path stops once it has gone all the way round the planet that pulled
+// hardest when it was rebuilt: past that point a closed orbit only retraces itself.
+class TrajectoryCache {
+private:
+    std::deque<TrajectorySample> samples;   // Front is at or just before the current time
+    bool valid = false;
+    bool hitPlanet = false;                 // The path ends at a planet and isn't extended
+    float timeStep = 0.0f;
+    IntegratorType integrator = IntegratorType::LEAPFROG;
+    TrajectoryMethod method = TrajectoryMethod::FIXED_STEP;
+    double adaptiveStep = 0.0;              // Next Dormand-Prince step to try
+    int primaryPlanet = -1;                 // Planet the orbit closure is measured around
+    std::vector<Vector2d> planetPull;       // Scratch for each planet's share of the pull
+    ConicTrajectory conic;                  // Refitted on every update that allows it
+    bool onConic = false;
+    double pathStart = 0.0;                 // Time of the rocket state the path was last updated from
+    unsigned long long ephemerisRevision = 0;
+    unsigned long long pathRevision = 0;
+    BodyStore planetScratch;                // Planets packed for each gravity query
+    size_t integratedSteps = 0;             // Prediction steps run so far
+    size_t forceEvaluations = 0;            // Gravity queries made by those steps
+    size_t rebuilds = 0;
+
+    // Where the path puts the rocket at a time between the first two samples
+    Vector2d interpolate(double time) const;
+    Vector2d interpolate(size_t segment, double time) const;
+    bool accelerationAt(PlanetEphemeris& table, const Vector2d& position, double time, Vector2d& acceleration);
+    bool startPath(PlanetEphemeris& table, TrajectorySample& start);
+    double sweepTo(PlanetEphemeris& table, const TrajectorySample& from, double time, const Vector2d& position);
+    void extend(PlanetEphemeris& table);
+    void extendAdaptive(PlanetEphemeris& table);
+
+    bool isAdaptive() const { return method != TrajectoryMethod::FIXED_STEP; }
+
+    static std::atomic<TrajectoryMethod> activeMethod;
+
+public:
+    // Bring the path up to time now for a rocket in this state, and make it reach steps
+    // fixed steps ahead in time. Planet gravity comes from the table, which may be a private copy.
+    // patchedConics should match the simulation, so the path follows the rocket's rails.
+    void update(PlanetEphemeris& table, double now, const Vector2d& position, const Vector2d& velocity,
+        unsigned long long revision, float step, int steps, bool patchedConics);
+
+    // The path as a line strip from the rocket's position, relative to a render origin and
+    // shaded blue to pink over the time of steps fixed steps. Adaptive and conic paths are tessellated for
+    // pixels of pixelSize world units, so the line is equally smooth at any zoom, and only
+    // the part inside bounds is kept. The table must be the one the path was last updated with.
+    void buildVertices(PlanetEphemeris& table, sf::VertexArray& vertices, const Vector2d& start,
+        const Vector2d& origin, int steps, bool detectSelfIntersection, double pixelSize,
+        const ViewBounds& bounds) const;
+
+    // Integrated part of the path; empty when a conic covers all of it
+    const std::deque<TrajectorySample>& getSamples() const { return samples; }
+    bool isOnConic() const { return onConic; }
+    const ConicTrajectory& getConic() const { return conic; }
+    bool endsAtPlanet() const;
+    // The path has gone a full revolution round its primary planet
+    bool isClosed() const;
+    size_t getIntegratedStepCount() const { return integratedSteps; }
+    size_t getForceEvaluationCount() const { return forceEvaluations; }
+    size_t getRebuildCount() const { return rebuilds; }
+
+    // Method used by every trajectory preview; safe to change while one is being computed
+    static TrajectoryMethod getActiveMethod();
+    static void setActiveMethod(TrajectoryMethod type);
+    static const char* getName(TrajectoryMethod type);
+};
\ No newline at end of file
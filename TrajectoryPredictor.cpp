@@ -0,0 +1,121 @@
+// TrajectoryPredictor.cpp
+#include "TrajectoryPredictor.h"
+#include "GameConstants.h"
+#include "GameObject.h"
+#include "GravitySimulator.h"
+#include "Rocket.h"
+
+TrajectoryPredictor::TrajectoryPredictor()
+    : back(sf::PrimitiveType::LineStrip), front(sf::PrimitiveType::LineStrip)
+{
+    worker = std::thread(&TrajectoryPredictor::workerLoop, this);
+}
+
+TrajectoryPredictor::~TrajectoryPredictor()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    pendingReady.notify_all();
+    worker.join();
+}
+
+void TrajectoryPredictor::submit(const Rocket& rocket, GravitySimulator& simulator, const sf::RenderWindow& window,
+    float timeStep, int steps)
+{
+    // The copy shares the planets' prescribed paths, which are pure functions of time
+    PlanetEphemeris& ephemeris = simulator.getEphemeris();
+    if (!sharedEphemeris || sharedEphemeris->getRevision() != ephemeris.getRevision()) {
+        sharedEphemeris = std::make_shared<const PlanetEphemeris>(ephemeris);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.rocket = &rocket;
+        pending.position = rocket.getWorldPosition();
+        pending.velocity = rocket.getWorldVelocity();
+        pending.pathRevision = rocket.getTrajectoryRevision();
+        pending.time = simulator.getSimulationTime();
+        pending.ephemeris = sharedEphemeris;
+        pending.renderOrigin = GameObject::getRenderOrigin();
+        pending.timeStep = timeStep;
+        pending.steps = steps;
+        // The view may move before the path is drawn, so take in a margin beyond it
+        pending.pixelSize = PolylineLod::getPixelSize(window);
+        pending.bounds = PolylineLod::getViewBounds(window, GameConstants::POLYLINE_LOD_MARGIN);
+        pending.patchedConics = simulator.getPatchedConics();
+        pending.generation = generation;
+        hasPending = true;
+    }
+    pendingReady.notify_one();
+}
+
+void TrajectoryPredictor::workerLoop()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex);
+            pendingReady.wait(lock, [this] { return stopping || hasPending; });
+            if (stopping) return;
+            std::swap(working, pending);
+            hasPending = false;
+        }
+
+        // A rebuilt table replaces the worker's copy; otherwise the copy carries on extending
+        // the same motion the simulation's table would
+        if (working.ephemeris != tableSource) {
+            table = *working.ephemeris;
+            tableSource = working.ephemeris;
+        }
+        table.discardBefore(working.time);
+
+        // A different rocket has nothing in common with the cached path, and neither does one
+        // submitted after a clear - it may be a new rocket at the old one's address
+        if (working.rocket != cachedRocket || working.generation != cachedGeneration) {
+            cache = TrajectoryCache();
+            cachedRocket = working.rocket;
+            cachedGeneration = working.generation;
+        }
+        cache.update(table, working.time, working.position, working.velocity,
+            working.pathRevision, working.timeStep, working.steps, working.patchedConics);
+        cache.buildVertices(table, back, working.position, working.renderOrigin, working.steps, true,
+            working.pixelSize, working.bounds);
+
+        std::lock_guard<std::mutex> lock(frontMutex);
+        if (working.generation != generation) continue;
+        std::swap(front, back);
+        frontOrigin = working.renderOrigin;
+        frontRocket = working.rocket;
+        completed++;
+    }
+}
+
+void TrajectoryPredictor::draw(sf::RenderWindow& window, const Rocket& rocket)
+{
+    std::lock_guard<std::mutex> lock(frontMutex);
+    if (frontRocket != &rocket || front.getVertexCount() == 0) return;
+
+    // The path was built around an older render origin; shift it to the current one
+    sf::RenderStates states;
+    states.transform.translate(sf::Vector2f(frontOrigin - GameObject::getRenderOrigin()));
+    window.draw(front, states);
+}
+
+void TrajectoryPredictor::clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        hasPending = false;
+    }
+    std::lock_guard<std::mutex> lock(frontMutex);
+    generation++;
+    front.clear();
+    frontRocket = nullptr;
+}
+
+size_t TrajectoryPredictor::getCompletedCount()
+{
+    std::lock_guard<std::mutex> lock(frontMutex);
+    return completed;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+// TrajectoryPredictor.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "PlanetEphemeris.h"
+#include "TrajectoryCache.h"
+#include "VectorHelper.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class GravitySimulator;
+class Rocket;
+
+// Runs the rocket's trajectory preview on its own thread so the frame never waits on it.
+// Each frame submits a snapshot - the rocket's state and the planet table - and draws
+// whichever path was finished last. The table is copied only when it is rebuilt; the worker
+// keeps its own copy of that and extends it as the path moves on, since reading extends it.
+// The worker builds into a back buffer and swaps it to the front under a short lock, so the
+// path on screen may trail the rocket by a frame or two but is always complete.
+class TrajectoryPredictor {
+private:
+    struct Snapshot {
+        const Rocket* rocket = nullptr;         // Identity only; never dereferenced by the worker
+        Vector2d position;
+        Vector2d velocity;
+        unsigned long long pathRevision = 0;
+        double time = 0.0;
+        std::shared_ptr<const PlanetEphemeris> ephemeris;   // Never changed once shared
+        Vector2d renderOrigin;
+        float timeStep = 0.0f;
+        int steps = 0;
+        double pixelSize = 1.0;                 // World units per pixel of the view the path is for
+        ViewBounds bounds;                      // World rectangle of that view
+        bool patchedConics = false;
+        unsigned long long generation = 0;      // Of the predictor when this was submitted
+    };
+
+    // Handed from the render thread to the worker; only the latest one is kept
+    std::mutex pendingMutex;
+    std::condition_variable pendingReady;
+    Snapshot pending;
+    bool hasPending = false;
+    bool stopping = false;
+    std::shared_ptr<const PlanetEphemeris> sharedEphemeris; // Last table handed over, render thread only
+    // Bumped by clear, so a path the worker was already building when it was called is dropped
+    // rather than published. Written by the render thread under frontMutex.
+    unsigned long long generation = 0;
+
+    // Worker-owned
+    Snapshot working;
+    std::shared_ptr<const PlanetEphemeris> tableSource;     // Where table was copied from
+    PlanetEphemeris table;
+    TrajectoryCache cache;
+    const Rocket* cachedRocket = nullptr;
+    unsigned long long cachedGeneration = 0;
+    sf::VertexArray back;
+
+    // Finished path, relative to the render origin of the snapshot it came from
+    std::mutex frontMutex;
+    sf::VertexArray front;
+    Vector2d frontOrigin;
+    const Rocket* frontRocket = nullptr;
+    size_t completed = 0;
+
+    std::thread worker;
+
+    void workerLoop();
+
+public:
+    TrajectoryPredictor();
+    ~TrajectoryPredictor();
+    TrajectoryPredictor(const TrajectoryPredictor&) = delete;
+    TrajectoryPredictor& operator=(const TrajectoryPredictor&) = delete;
+
+    // Ask for the path of this rocket as it is now, for drawing in the window's current view.
+    // Cheap apart from copying the planet table when it was rebuilt; a snapshot the worker
+    // hasn't started on yet is replaced.
+    void submit(const Rocket& rocket, GravitySimulator& simulator, const sf::RenderWindow& window,
+        float timeStep, int steps);
+
+    // Draw the last finished path of this rocket, if there is one, at the current render origin
+    void draw(sf::RenderWindow& window, const Rocket& rocket);
+
+    // Forget the current path, e.g. when the rocket is gone
+    void clear();
+
+    // Paths finished so far
+    size_t getCompletedCount();
+};
\ No newline at end of file
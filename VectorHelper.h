@@ -4,6 +4,9 @@
 
 // Rest of the code remains the same
 
+// Double-precision vector for simulation state; SFML only draws sf::Vector2f
+using Vector2d = sf::Vector2<double>;
+
 // Vector2 helper functions
 inline sf::Vector2f normalize(const sf::Vector2f& source) {
     float length = std::sqrt(source.x * source.x + source.y * source.y);
@@ -15,4 +18,16 @@ inline sf::Vector2f normalize(const sf::Vector2f& source) {
 inline float distance(const sf::Vector2f& a, const sf::Vector2f& b) {
     sf::Vector2f diff = b - a;
     return std::sqrt(diff.x * diff.x + diff.y * diff.y);
+}
+
+inline Vector2d normalize(const Vector2d& source) {
+    double length = std::sqrt(source.x * source.x + source.y * source.y);
+    if (length != 0)
+        return source / length;
+    return source;
+}
+
+inline double distance(const Vector2d& a, const Vector2d& b) {
+    Vector2d diff = b - a;
+    return std::sqrt(diff.x * diff.x + diff.y * diff.y);
 }
\ No newline at end of file
@@ -50,7 +50,10 @@ void VehicleManager::update(float deltaTime) {
         rocket->update(deltaTime);
     }
     else {
-        car->checkGrounding(planets);
+        // A parked car stays on the planet it slept on
+        if (!car->isSleeping()) {
+            car->checkGrounding(planets);
+        }
         car->update(deltaTime);
     }
 }
@@ -12,6 +12,12 @@
 #include "GameClient.h"
 #include "GameState.h"
 #include "PlayerInput.h"
+#include "SimulationClock.h"
+#include "Integrator.h"
+#include "KeplerOrbit.h"
+#include "TrajectoryPredictor.h"
+#include "OrbitPathCache.h"
+#include "BatchTrajectoryPredictor.h"
 #include <memory>
 #include <vector>
 #include <cstdint> // For uint8_t
@@ -82,51 +88,17 @@ public:
     }
 };
 
-// Helper functions to calculate orbital parameters
+// Helper functions to calculate orbital parameters (closed orbits only, -1 otherwise)
 float calculateApoapsis(sf::Vector2f pos, sf::Vector2f vel, float planetMass, float G) {
-    // Calculate specific orbital energy
-    float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y);
-    float distance = std::sqrt(pos.x * pos.x + pos.y * pos.y);
-    float energy = 0.5f * speed * speed - G * planetMass / distance;
-
-    // Calculate semi-major axis
-    float semiMajor = -G * planetMass / (2 * energy);
-
-    // If energy is positive, orbit is hyperbolic (no apoapsis)
-    if (energy >= 0) return -1.0f;
-
-    // Calculate eccentricity vector
-    sf::Vector2f eVec;
-    float vSquared = speed * speed;
-    eVec.x = (vSquared * pos.x - (pos.x * vel.x + pos.y * vel.y) * vel.x) / (G * planetMass) - pos.x / distance;
-    eVec.y = (vSquared * pos.y - (pos.x * vel.x + pos.y * vel.y) * vel.y) / (G * planetMass) - pos.y / distance;
-    float ecc = std::sqrt(eVec.x * eVec.x + eVec.y * eVec.y);
-
-    // Calculate apoapsis
-    return semiMajor * (1 + ecc);
+    KeplerOrbit orbit(Vector2d(pos), Vector2d(vel), static_cast<double>(G) * planetMass);
+    if (!orbit.isBound()) return -1.0f;
+    return static_cast<float>(orbit.getApoapsis());
 }
 
 float calculatePeriapsis(sf::Vector2f pos, sf::Vector2f vel, float planetMass, float G) {
-    // Calculate specific orbital energy
-    float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y);
-    float distance = std::sqrt(pos.x * pos.x + pos.y * pos.y);
-    float energy = 0.5f * speed * speed - G * planetMass / distance;
-
-    // Calculate semi-major axis
-    float semiMajor = -G * planetMass / (2 * energy);
-
-    // If energy is positive, orbit is hyperbolic
-    if (energy >= 0) return -1.0f;
-
-    // Calculate eccentricity vector
-    sf::Vector2f eVec;
-    float vSquared = speed * speed;
-    eVec.x = (vSquared * pos.x - (pos.x * vel.x + pos.y * vel.y) * vel.x) / (G * planetMass) - pos.x / distance;
-    eVec.y = (vSquared * pos.y - (pos.x * vel.x + pos.y * vel.y) * vel.y) / (G * planetMass) - pos.y / distance;
-    float ecc = std::sqrt(eVec.x * eVec.x + eVec.y * eVec.y);
-
-    // Calculate periapsis
-    return semiMajor * (1 - ecc);
+    KeplerOrbit orbit(Vector2d(pos), Vector2d(vel), static_cast<double>(G) * planetMass);
+    if (!orbit.isBound()) return -1.0f;
+    return static_cast<float>(orbit.getPeriapsis());
 }
 
 // Parse command line arguments for multiplayer setup
@@ -600,6 +572,7 @@ int main(int argc, char* argv[])
             0, GameConstants::MAIN_PLANET_MASS, sf::Color::Blue);
         // Set zero velocity to ensure it stays in place
         planet->setVelocity(sf::Vector2f(0.f, 0.f));
+        planet->setMotionSource(MotionSource::PINNED);
 
         // Create a second planet - position it using the calculated position
         Planet* planet2 = new Planet(sf::Vector2f(GameConstants::SECONDARY_PLANET_X, GameConstants::SECONDARY_PLANET_Y),
@@ -638,15 +611,40 @@ int main(int argc, char* argv[])
     }
     gravitySimulator.addVehicleManager(activeVehicleManager);
 
+    // Trajectory and orbit previews read the planet table of whichever simulator steps the planets,
+    // and the simulation toggles below change that one too
+    GravitySimulator* predictionSimulator = &gravitySimulator;
+    if (isMultiplayer && isHost && gameServer) {
+        predictionSimulator = &gameServer->getSimulator();
+    }
+    else if (isMultiplayer && gameClient) {
+        predictionSimulator = &gameClient->getSimulator();
+    }
+
+    // The rocket's trajectory preview is computed off the render thread
+    TrajectoryPredictor trajectoryPredictor;
+    // Planet orbit lines are tessellated once and only moved from frame to frame
+    OrbitPathCache orbitPaths;
+    // The other players' paths, predicted together each frame
+    BatchTrajectoryPredictor otherTrajectories;
+    std::vector<const Rocket*> otherRockets;
+
     // Track L key state to prevent repeated transformations
     bool lKeyPressed = false;
 
+    // Physics runs in fixed steps; rendering interpolates between the last two
+    SimulationClock simulationClock;
+
     // Main game loop
     while (window.isOpen())
     {
         // Calculate delta time
         float deltaTime = std::min(clock.restart().asSeconds(), 0.1f);
 
+        // Number of fixed simulation steps owed for this frame
+        int simulationSteps = simulationClock.advance(deltaTime);
+        float fixedDeltaTime = simulationClock.getFixedDeltaTime();
+
         // Update network state for multiplayer
         if (isMultiplayer) {
             // Update network manager to handle connections
@@ -658,7 +656,9 @@ int main(int argc, char* argv[])
 
             if (isHost) {
                 // Update server simulation
-                gameServer->update(deltaTime);
+                for (int step = 0; step < simulationSteps; step++) {
+                    gameServer->update(fixedDeltaTime);
+                }
 
                 // Send updated game state to clients every 50ms (20 times per second)
                 static sf::Clock stateUpdateClock;
@@ -685,7 +685,9 @@ int main(int argc, char* argv[])
                 }
 
                 // Update client prediction and interpolation
-                gameClient->update(deltaTime);
+                for (int step = 0; step < simulationSteps; step++) {
+                    gameClient->update(fixedDeltaTime);
+                }
                 gameClient->interpolateRemotePlayers(gameTime);
             }
 
@@ -783,9 +785,56 @@ int main(int argc, char* argv[])
                     else if (keyEvent->code == sf::Keyboard::Key::P)
                     {
                         // Toggle planet gravity simulation with 'P' key
-                        static bool planetGravity = true;
-                        planetGravity = !planetGravity;
-                        gravitySimulator.setSimulatePlanetGravity(planetGravity);
+                        predictionSimulator->setSimulatePlanetGravity(!predictionSimulator->getSimulatePlanetGravity());
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::G)
+                    {
+                        // Toggle between exact pairwise and Barnes-Hut gravity with 'G' key
+                        // Rockets pull on each other within the cutoff under pairwise, and through the tree under Barnes-Hut
+                        bool useTree = predictionSimulator->getGravitySolver() == GravitySolver::PAIRWISE;
+                        predictionSimulator->setGravitySolver(useTree ? GravitySolver::BARNES_HUT : GravitySolver::PAIRWISE);
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::I)
+                    {
+                        // Cycle Euler -> leapfrog -> Yoshida 4 with 'I' key (also used by the trajectory preview)
+                        IntegratorType current = Integrator::getActiveType();
+                        IntegratorType next = current == IntegratorType::SEMI_IMPLICIT_EULER ? IntegratorType::LEAPFROG :
+                            current == IntegratorType::LEAPFROG ? IntegratorType::YOSHIDA4 : IntegratorType::SEMI_IMPLICIT_EULER;
+                        Integrator::setActiveType(next);
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::R)
+                    {
+                        // Toggle adaptive Dormand-Prince and fixed-step trajectory prediction with 'R' key
+                        bool adaptive = TrajectoryCache::getActiveMethod() == TrajectoryMethod::DORMAND_PRINCE;
+                        TrajectoryCache::setActiveMethod(adaptive ? TrajectoryMethod::FIXED_STEP : TrajectoryMethod::DORMAND_PRINCE);
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::T)
+                    {
+                        // Toggle per-body block timesteps with 'T' key
+                        predictionSimulator->setAdaptiveTimesteps(!predictionSimulator->getAdaptiveTimesteps());
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::K)
+                    {
+                        // Toggle patched-conic rails for coasting rockets with 'K' key
+                        predictionSimulator->setPatchedConics(!predictionSimulator->getPatchedConics());
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::E)
+                    {
+                        // Toggle energy and momentum drift telemetry with 'E' key
+                        predictionSimulator->setDiagnosticsEnabled(!predictionSimulator->getDiagnosticsEnabled());
+                    }
+                    else if (keyEvent->code == sf::Keyboard::Key::B && !planets.empty())
+                    {
+                        // Toggle an asteroid belt of massless particles around the main planet with 'B' key
+                        ParticlePool& particles = predictionSimulator->getParticles();
+                        if (particles.empty()) {
+                            particles.addRing(planets[0]->getWorldPosition(), planets[0]->getWorldVelocity(),
+                                planets[0]->getMass(), GameConstants::ASTEROID_BELT_INNER_RADIUS,
+                                GameConstants::ASTEROID_BELT_OUTER_RADIUS, GameConstants::ASTEROID_BELT_PARTICLES);
+                        }
+                        else {
+                            particles.clear();
+                        }
                     }
                     else if (keyEvent->code == sf::Keyboard::Key::L && !lKeyPressed && !isMultiplayer)
                     {
@@ -896,12 +945,12 @@ int main(int argc, char* argv[])
         }
         // For clients, input is captured in GameClient::getLocalPlayerInput() and sent via network
 
-        // Camera control keys
+        // Camera control keys. The view is centered once the render origin for this frame is known.
+        const GameObject* cameraTarget = activeVehicleManager->getActiveVehicle();
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Z)) {
             // Gradually increase zoom to see more of the system
             targetZoom = std::min(maxZoom, targetZoom * 1.05f); // Increase by 5% each frame
-            // Focus on active vehicle
-            gameView.setCenter(activeVehicleManager->getActiveVehicle()->getPosition());
+            // Focus on active vehicle (the default camera target)
         }
         else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::X)) {
             // Follow the active vehicle - calculate distances manually
@@ -914,23 +963,32 @@ int main(int argc, char* argv[])
                 std::pow(activeVehicleManager->getActiveVehicle()->getPosition().y - planets[1]->getPosition().y, 2)
             );
             targetZoom = minZoom + (std::min(dist1, dist2) - (planets[0]->getRadius() + GameConstants::ROCKET_SIZE)) / 100.0f;
-            gameView.setCenter(activeVehicleManager->getActiveVehicle()->getPosition());
         }
         else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::C)) {
             // Follow planet 2
             targetZoom = 10.0f;
-            gameView.setCenter(planets[1]->getPosition());
+            cameraTarget = planets[1];
         }
 
-        // Update simulation if not in multiplayer client mode
-        if (!isMultiplayer || isHost) {
-            gravitySimulator.update(deltaTime);
-            for (auto planet : planets) {
-                planet->update(deltaTime);
+        // Update simulation in single player - the host's GameServer already steps
+        // every player, including its own, in gameServer->update
+        if (!isMultiplayer) {
+            for (int step = 0; step < simulationSteps; step++) {
+                gravitySimulator.update(fixedDeltaTime);
+                for (auto planet : planets) {
+                    planet->update(fixedDeltaTime);
+                }
+                activeVehicleManager->update(fixedDeltaTime);
             }
-            activeVehicleManager->update(deltaTime);
         }
 
+        // Draw everything partway between the last two simulation steps
+        GameObject::setRenderAlpha(simulationClock.getAlpha());
+
+        // Floating origin: rebase rendering around the active vehicle every frame so the
+        // view and every vertex stay small floats however far out the world goes
+        GameObject::setRenderOrigin(activeVehicleManager->getActiveVehicle()->getInterpolatedPosition());
+
         // Calculate distance from vehicle to closest planet for zoom
         sf::Vector2f vehiclePos = activeVehicleManager->getActiveVehicle()->getPosition();
         sf::Vector2f vehicleToPlanet1 = planets[0]->getPosition() - vehiclePos;
@@ -945,11 +1003,11 @@ int main(int argc, char* argv[])
             float closest = std::min(distance1, distance2);
             targetZoom = minZoom + (closest - (planets[0]->getRadius() + GameConstants::ROCKET_SIZE)) / 100.0f;
             targetZoom = std::max(minZoom, std::min(targetZoom, maxZoom));
-
-            // Update view center to follow vehicle
-            gameView.setCenter(vehiclePos);
         }
 
+        // Follow the camera target in render space
+        gameView.setCenter(cameraTarget->getRenderPosition());
+
         // Smoothly interpolate current zoom to target zoom
         zoomLevel += (targetZoom - zoomLevel) * deltaTime * zoomSpeed;
 
@@ -962,32 +1020,48 @@ int main(int argc, char* argv[])
         // Clear window with black background
         window.clear(sf::Color::Black);
 
-        // Find the closest planet to the rocket
-        Planet* closestPlanet = nullptr;
-        float closestDistance = std::numeric_limits<float>::max();
-        sf::Vector2f rocketPos = activeVehicleManager->getActiveVehicle()->getPosition();
+        // Both previews sample the same planet table instead of re-simulating the planets
+        // Draw the orbit of every planet from the cache
+        orbitPaths.draw(window, *predictionSimulator);
 
-        for (auto& planetPtr : planets) {
-            sf::Vector2f direction = planetPtr->getPosition() - rocketPos;
-            float dist = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-            if (dist < closestDistance) {
-                closestDistance = dist;
-                closestPlanet = planetPtr;
-            }
+        // Draw trajectory only if in rocket mode
+        if (activeVehicleManager->getActiveVehicleType() == VehicleType::ROCKET) {
+            const Rocket& rocket = *activeVehicleManager->getRocket();
+            trajectoryPredictor.submit(rocket, *predictionSimulator, window,
+                GameConstants::TRAJECTORY_TIME_STEP, GameConstants::TRAJECTORY_STEPS);
+            trajectoryPredictor.draw(window, rocket);
         }
-
-        // Draw orbit path only for the closest planet
-        if (closestPlanet) {
-            closestPlanet->drawOrbitPath(window, planets);
+        else {
+            trajectoryPredictor.clear();
         }
 
-        // Draw trajectory only if in rocket mode
-        if (activeVehicleManager->getActiveVehicleType() == VehicleType::ROCKET) {
-            activeVehicleManager->getRocket()->drawTrajectory(window, planets,
-                GameConstants::TRAJECTORY_TIME_STEP, GameConstants::TRAJECTORY_STEPS, false);
+        // Hosts and spectators also see where every other player's rocket is heading
+        if (isMultiplayer) {
+            otherRockets.clear();
+            auto addPlayer = [&](const VehicleManager* player) {
+                if (player != activeVehicleManager && player->getActiveVehicleType() == VehicleType::ROCKET &&
+                    player->getRocket()) {
+                    otherRockets.push_back(player->getRocket());
+                }
+            };
+            if (isHost) {
+                for (const auto& pair : gameServer->getPlayers()) {
+                    addPlayer(pair.second);
+                }
+            }
+            else {
+                for (const auto& player : gameClient->getRemotePlayers()) {
+                    addPlayer(player.second);
+                }
+            }
+            otherTrajectories.submit(otherRockets, *predictionSimulator, window,
+                GameConstants::TRAJECTORY_TIME_STEP, GameConstants::TRAJECTORY_STEPS);
+            otherTrajectories.draw(window);
         }
 
+        // Massless particles behind everything else
+        predictionSimulator->getParticles().draw(window, GameObject::getRenderAlpha());
+
         // Draw objects
         for (auto planet : planets) {
             planet->draw(window);
@@ -1019,7 +1093,16 @@ int main(int argc, char* argv[])
             activeVehicleManager->drawVelocityVector(window, 2.0f);
 
             // Draw gravity force vectors only in rocket mode
-            activeVehicleManager->getRocket()->drawGravityForceVectors(window, planets, GameConstants::GRAVITY_VECTOR_SCALE);
+            activeVehicleManager->getRocket()->drawGravityForceVectors(window, *predictionSimulator, GameConstants::GRAVITY_VECTOR_SCALE);
+        }
+
+        // Each planet's pull on the rocket, queried once for every panel below
+        const std::vector<Planet*>& gravityPlanets = predictionSimulator->getPlanets();
+        std::vector<Vector2d> gravityShares(gravityPlanets.size());
+        if (activeVehicleManager->getActiveVehicleType() == VehicleType::ROCKET) {
+            Vector2d totalGravity;
+            predictionSimulator->accelerationsAt(&activeVehicleManager->getRocket()->getWorldPosition(), 1,
+                predictionSimulator->getSimulationTime(), &totalGravity, gravityShares.data());
         }
 
         // Update info panels with current data
@@ -1041,11 +1124,10 @@ int main(int argc, char* argv[])
                 // Calculate total gravity force from all planets
                 float totalForce = 0.0f;
 
-                for (const auto& planetPtr : planets) {
-                    sf::Vector2f direction = planetPtr->getPosition() - rocket->getPosition();
-                    float dist = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                    float forceMagnitude = G * planetPtr->getMass() * rocket->getMass() / (dist * dist);
+                for (size_t j = 0; j < gravityPlanets.size(); j++) {
+                    const Planet* planetPtr = gravityPlanets[j];
+                    float forceMagnitude = static_cast<float>(std::sqrt(gravityShares[j].x * gravityShares[j].x +
+                        gravityShares[j].y * gravityShares[j].y)) * rocket->getMass();
                     totalForce += forceMagnitude;
 
                     // Label planets by color for clarity
@@ -1111,14 +1193,12 @@ int main(int argc, char* argv[])
                 float strongestGravity = 0.0f;
 
                 // Find the primary gravitational body (usually the closest one)
-                for (const auto& planetPtr : planets) {
-                    sf::Vector2f direction = planetPtr->getPosition() - rocket->getPosition();
-                    float dist = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                    float gravityStrength = G * planetPtr->getMass() / (dist * dist);
+                for (size_t j = 0; j < gravityPlanets.size(); j++) {
+                    float gravityStrength = static_cast<float>(std::sqrt(gravityShares[j].x * gravityShares[j].x +
+                        gravityShares[j].y * gravityShares[j].y));
                     if (gravityStrength > strongestGravity) {
                         strongestGravity = gravityStrength;
-                        primaryBody = planetPtr;
+                        primaryBody = gravityPlanets[j];
                     }
                 }
 
@@ -1167,13 +1247,16 @@ int main(int argc, char* argv[])
 
             // Calculate the closest planet for gravity reference
             Planet* closestPlanet = nullptr;
+            size_t closestIndex = 0;
             float closestDistance = std::numeric_limits<float>::max();
 
-            for (const auto& planetPtr : planets) {
+            for (size_t j = 0; j < gravityPlanets.size(); j++) {
+                Planet* planetPtr = gravityPlanets[j];
                 float dist = std::sqrt(std::pow(rocketPos.x - planetPtr->getPosition().x, 2) + std::pow(rocketPos.y - planetPtr->getPosition().y, 2));
                 if (dist < closestDistance) {
                     closestDistance = dist;
                     closestPlanet = planetPtr;
+                    closestIndex = j;
                 }
             }
 
@@ -1183,7 +1266,8 @@ int main(int argc, char* argv[])
                 float dist = std::sqrt(towardsPlanet.x * towardsPlanet.x + towardsPlanet.y * towardsPlanet.y);
                 sf::Vector2f gravityDir = normalize(towardsPlanet);
                 // Calculate weight (gravity force) at current position
-                float weight = G * rocket->getMass() * closestPlanet->getMass() / (dist * dist);
+                const Vector2d& pull = gravityShares[closestIndex];
+                float weight = static_cast<float>(std::sqrt(pull.x * pull.x + pull.y * pull.y)) * rocket->getMass();
 
                 // Calculate current thrust force based on thrust level
                 float maxThrust = 0.0f;
@@ -1248,6 +1332,20 @@ int main(int argc, char* argv[])
             multiplayerPanel.setText("SINGLE PLAYER MODE\nPress ESC to exit");
         }
 
+        // Conservation drift panel, while the telemetry is on
+        TextPanel diagnosticsPanel(font, 12, sf::Vector2f(1020, 10), sf::Vector2f(250, 100));
+        if (predictionSimulator->getDiagnosticsEnabled()) {
+            const ConservationDrift& drift = predictionSimulator->getDiagnostics().getDrift();
+            std::stringstream ss;
+            ss << "CONSERVATION DRIFT\n"
+                << std::scientific << std::setprecision(2)
+                << "Energy: " << drift.energy << " (max " << drift.maxEnergy << ")\n"
+                << "Momentum: " << drift.momentum << " (max " << drift.maxMomentum << ")\n"
+                << "Ang. momentum: " << drift.angularMomentum << " (max " << drift.maxAngularMomentum << ")\n"
+                << "Samples: " << drift.samples << ", " << drift.disturbedSamples << " with thrust/contact";
+            diagnosticsPanel.setText(ss.str());
+        }
+
         // Now switch to UI view for drawing all panels
         window.setView(uiView);
 
@@ -1260,6 +1358,9 @@ int main(int argc, char* argv[])
         if (isMultiplayer) {
             multiplayerPanel.draw(window);
         }
+        if (predictionSimulator->getDiagnosticsEnabled()) {
+            diagnosticsPanel.draw(window);
+        }
 
         // Update and draw buttons
         sf::Vector2f mousePos = window.mapPixelToCoords(